@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "utility/exponential_blur.h"
+
+#include "exponential_blur_reference.h"
+
+using namespace spring::player;
+
+/* Times the current blur against the scalar one it replaced, on noise at the sizes the */
+/* thumbnails and the full-window background are blurred at, and checks the output.     */
+namespace
+{
+    constexpr std::int32_t RADIUS{ 5 };
+    constexpr std::size_t ITERATIONS{ 25 };
+
+    struct image_size_t
+    {
+        std::int32_t width;
+        std::int32_t height;
+    };
+
+    constexpr image_size_t IMAGE_SIZES[]{ { 200, 200 }, { 512, 512 }, { 1920, 1080 } };
+
+    std::vector<std::uint8_t> noise(std::size_t size) noexcept
+    {
+        std::mt19937 generator{ 42 };
+        std::uniform_int_distribution<std::uint32_t> distribution{ 0, 255 };
+
+        std::vector<std::uint8_t> result(size);
+        for (auto &byte : result)
+        {
+            byte = static_cast<std::uint8_t>(distribution(generator));
+        }
+
+        return result;
+    }
+
+    /* Median of ITERATIONS runs, every run blurs a fresh copy of source */
+    template <typename Blur>
+    double median_milliseconds(const std::vector<std::uint8_t> &source, Blur &&blur) noexcept
+    {
+        std::vector<double> timings;
+        timings.reserve(ITERATIONS);
+
+        for (std::size_t it = 0; it < ITERATIONS; ++it)
+        {
+            auto pixels = source;
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            blur(pixels.data());
+            const auto end = std::chrono::high_resolution_clock::now();
+
+            timings.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        std::nth_element(timings.begin(), timings.begin() + ITERATIONS / 2, timings.end());
+        return timings[ITERATIONS / 2];
+    }
+
+    template <std::size_t channel_count> void run(const image_size_t &size) noexcept
+    {
+        const auto rowstride = size.width * static_cast<std::int32_t>(channel_count);
+        const auto source = noise(static_cast<std::size_t>(rowstride) * size.height);
+
+        const auto reference_blur = [&size](std::uint8_t *pixels) {
+            reference::exponential_blur<channel_count>(pixels, size.width, size.height, RADIUS);
+        };
+        const auto current_blur = [&size, rowstride](std::uint8_t *pixels) {
+            utility::exponential_blur(pixels, size.width, size.height, rowstride,
+                                      static_cast<std::int32_t>(channel_count), RADIUS);
+        };
+
+        /* The old column pass never blurred the last row, so the backward pass starts from */
+        /* a different state and the bottom rows drift apart. Everything above must match.  */
+        auto expected = source;
+        auto actual = source;
+        reference_blur(expected.data());
+        current_blur(actual.data());
+        const auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin());
+        const auto matching_rows = (mismatch.first - expected.begin()) / rowstride;
+
+        const auto old_ms = median_milliseconds(source, reference_blur);
+        const auto new_ms = median_milliseconds(source, current_blur);
+
+        fmt::print("{:>4}x{:<4} {:>8} {:>10.3f} {:>10.3f} {:>8.2f}x {:>13}\n", size.width,
+                   size.height, channel_count, old_ms, new_ms, old_ms / new_ms, matching_rows);
+    }
+} // namespace
+
+int main()
+{
+    fmt::print("Blur radius {}, median of {} runs\n\n", RADIUS, ITERATIONS);
+    fmt::print("{:<9} {:>8} {:>10} {:>10} {:>9} {:>13}\n", "size", "channels", "old ms",
+               "new ms", "speedup", "matching rows");
+
+    for (const auto &size : IMAGE_SIZES)
+    {
+        run<3>(size);
+        run<4>(size);
+    }
+
+    return 0;
+}
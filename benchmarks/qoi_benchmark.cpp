@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gdk/gdk.h>
+
+#include <fmt/format.h>
+
+#include "utility/pixbuf_loader.h"
+#include "utility/qoi_codec.h"
+
+using namespace spring::player::utility;
+
+/* Compares keeping artwork in the cache as QOI against keeping the raw pixels or a JPEG, */
+/* by size and by the time it takes to get a pixbuf back, the way artwork_loader does it. */
+namespace
+{
+    constexpr std::size_t ITERATIONS{ 25 };
+
+    /* The sizes artwork::LEVELS caches */
+    constexpr int LEVELS[]{ 64, 128, 256, 512 };
+
+    /* Median of ITERATIONS runs of decode, which returns a new pixbuf or nullptr */
+    template <typename Decode> double median_milliseconds(Decode &&decode) noexcept
+    {
+        std::vector<double> timings;
+        timings.reserve(ITERATIONS);
+
+        for (std::size_t it = 0; it < ITERATIONS; ++it)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            GdkPixbuf *pixbuf = decode();
+            const auto end = std::chrono::high_resolution_clock::now();
+
+            if (pixbuf == nullptr)
+            {
+                return -1.0;
+            }
+            g_object_unref(pixbuf);
+
+            timings.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        std::nth_element(timings.begin(), timings.begin() + ITERATIONS / 2, timings.end());
+        return timings[ITERATIONS / 2];
+    }
+
+    void print_row(const char *encoding, std::size_t size, std::size_t raw_size, double ms) noexcept
+    {
+        fmt::print("    {:<6} {:>10} {:>7.1f}% {:>10.3f}\n", encoding, size,
+                   100.0 * size / raw_size, ms);
+    }
+
+    void run(GdkPixbuf *pixbuf) noexcept
+    {
+        const auto width = gdk_pixbuf_get_width(pixbuf);
+        const auto height = gdk_pixbuf_get_height(pixbuf);
+        const auto rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+        const auto channel_count = gdk_pixbuf_get_n_channels(pixbuf);
+        const auto alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+        const auto pixels = gdk_pixbuf_read_pixels(pixbuf);
+        const auto raw_size = static_cast<std::size_t>(rowstride) * height;
+
+        fmt::print("  {}x{}, {} channels\n", width, height, channel_count);
+
+        /* Wrapped where it lies, like the cache does with the pack store's mapping */
+        auto raw = g_bytes_new_static(pixels, raw_size);
+        const auto raw_ms = median_milliseconds([&] {
+            return gdk_pixbuf_new_from_bytes(raw, GDK_COLORSPACE_RGB, alpha, 8, width, height,
+                                             rowstride);
+        });
+        g_bytes_unref(raw);
+        print_row("raw", raw_size, raw_size, raw_ms);
+
+        const auto encoded = qoi::encode(pixels, width, height, rowstride, channel_count);
+        const auto qoi_ms = median_milliseconds([&]() -> GdkPixbuf * {
+            auto result = gdk_pixbuf_new(GDK_COLORSPACE_RGB, alpha, 8, width, height);
+            if (result != nullptr &&
+                !qoi::decode(encoded.data(), encoded.size(), gdk_pixbuf_get_pixels(result), width,
+                             height, gdk_pixbuf_get_rowstride(result), channel_count))
+            {
+                g_object_unref(result);
+                result = nullptr;
+            }
+            return result;
+        });
+        print_row("qoi", encoded.size(), raw_size, qoi_ms);
+
+        /* JPEG drops the alpha channel, it's only there to compare against */
+        gchar *buffer{ nullptr };
+        gsize buffer_size{ 0 };
+        if (!gdk_pixbuf_save_to_buffer(pixbuf, &buffer, &buffer_size, "jpeg", nullptr,
+                                       "quality", "90", nullptr))
+        {
+            fmt::print("    jpeg   failed to encode\n");
+            return;
+        }
+        const std::string jpeg(buffer, buffer_size);
+        g_free(buffer);
+
+        const auto jpeg_ms = median_milliseconds([&] { return load_pixbuf_from_data(jpeg); });
+        print_row("jpeg", jpeg.size(), raw_size, jpeg_ms);
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fmt::print(stderr, "Usage: {} IMAGE...\n", argv[0]);
+        return 1;
+    }
+
+    fmt::print("Median of {} runs, JPEG at quality 90\n", ITERATIONS);
+
+    for (int it = 1; it < argc; ++it)
+    {
+        GError *error{ nullptr };
+        auto image = gdk_pixbuf_new_from_file(argv[it], &error);
+        if (image == nullptr)
+        {
+            fmt::print(stderr, "Failed to load {}: {}\n", argv[it], error->message);
+            g_error_free(error);
+            continue;
+        }
+
+        fmt::print("\n{}\n", argv[it]);
+        fmt::print("    {:<6} {:>10} {:>8} {:>10}\n", "format", "bytes", "of raw", "decode ms");
+
+        for (auto level : LEVELS)
+        {
+            auto scaled = gdk_pixbuf_scale_simple(image, level, level, GDK_INTERP_BILINEAR);
+            if (scaled != nullptr)
+            {
+                run(scaled);
+                g_object_unref(scaled);
+            }
+        }
+
+        g_object_unref(image);
+    }
+
+    return 0;
+}
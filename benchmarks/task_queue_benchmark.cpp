@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <concurrentqueue.h>
+
+#include <fmt/format.h>
+
+#include "utility/async_queue.h"
+
+using namespace spring::player::utility;
+
+/* Every allocation made while the benchmark runs, to show which tasks end up on the heap */
+static std::atomic<std::uint64_t> allocation_count{ 0 };
+
+/* Written by every task so the work can't be optimized away */
+std::uint64_t task_sink{ 0 };
+
+void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto result = std::malloc(size == 0 ? 1 : size))
+    {
+        return result;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+/* Queues 100k tasks through the same kind of queue async_queue uses and runs them, once */
+/* with std::function as Request used to hold and once with async_queue::Task.           */
+namespace
+{
+    constexpr std::size_t TASK_COUNT{ 100000 };
+    constexpr std::size_t ITERATIONS{ 15 };
+
+    template <typename task_t> struct envelope_t
+    {
+        const char *id;
+        task_t task;
+    };
+
+    struct result_t
+    {
+        double milliseconds;
+        std::uint64_t allocations;
+    };
+
+    /* Median time of ITERATIONS rounds of queuing TASK_COUNT tasks made by make_task and */
+    /* then dequeuing and running all of them, with the allocations of one round          */
+    template <typename task_t, typename MakeTask> result_t run(MakeTask &&make_task) noexcept
+    {
+        std::vector<double> timings;
+        timings.reserve(ITERATIONS);
+        std::uint64_t allocations{ 0 };
+
+        for (std::size_t it = 0; it < ITERATIONS; ++it)
+        {
+            moodycamel::ConcurrentQueue<envelope_t<task_t>> queue{ TASK_COUNT };
+
+            const auto allocations_before = allocation_count.load();
+            const auto start = std::chrono::high_resolution_clock::now();
+
+            for (std::size_t task = 0; task < TASK_COUNT; ++task)
+            {
+                queue.enqueue(envelope_t<task_t>{ "benchmark", make_task(task) });
+            }
+
+            envelope_t<task_t> envelope{ nullptr, nullptr };
+            while (queue.try_dequeue(envelope))
+            {
+                envelope.task();
+                envelope.task = nullptr;
+            }
+
+            const auto end = std::chrono::high_resolution_clock::now();
+            allocations = allocation_count.load() - allocations_before;
+
+            timings.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        std::nth_element(timings.begin(), timings.begin() + ITERATIONS / 2, timings.end());
+        return { timings[ITERATIONS / 2], allocations };
+    }
+
+    template <typename MakeTask> void compare(const char *capture, MakeTask make_task) noexcept
+    {
+        const auto function = run<std::function<void()>>(make_task);
+        const auto inline_task = run<async_queue::Task>(make_task);
+
+        fmt::print("{:<28} {:>10.3f} {:>8} {:>10.3f} {:>8} {:>8.2f}x\n", capture,
+                   function.milliseconds, function.allocations, inline_task.milliseconds,
+                   inline_task.allocations, function.milliseconds / inline_task.milliseconds);
+    }
+} // namespace
+
+int main()
+{
+    fmt::print("{} tasks per round, median of {} rounds\n\n", TASK_COUNT, ITERATIONS);
+    fmt::print("{:<28} {:>10} {:>8} {:>10} {:>8} {:>9}\n", "capture", "function", "allocs",
+               "inline", "allocs", "speedup");
+
+    compare("pointer (8 bytes)", [](std::size_t task) {
+        auto counter = &task_sink;
+        return [counter, task] { *counter += task; };
+    });
+
+    /* What the UI usually captures: this, a lifeline and a shared object */
+    auto shared = std::make_shared<std::string>("artist");
+    std::weak_ptr<void> lifeline{ shared };
+    compare("this + weak + shared (48)", [&shared, &lifeline](std::size_t task) {
+        auto counter = &task_sink;
+        return [counter, lifeline, shared, task] {
+            *counter += task + shared->size() + (lifeline.expired() ? 0 : 1);
+        };
+    });
+
+    /* Bigger than async_queue::Task keeps inline, so both allocate */
+    compare("128 byte array", [](std::size_t task) {
+        std::array<std::uint64_t, 16> values{};
+        values[task % values.size()] = task;
+        return [values] { task_sink += values[0]; };
+    });
+
+    return 0;
+}
@@ -9,10 +9,14 @@
 
 #include "spring_player.h"
 
+#include "utility/startup_timer.h"
+
 GRESOURCE_UI_DECLARE_RESOURCE();
 
 int main(int argc, char *argv[])
 {
+    spring::player::utility::startup_timer::start();
+
     textdomain(APPLICATION_ID);
 
     auto ui = GRESOURCE_UI_INIT_RESOURCE();
@@ -67,7 +67,7 @@ namespace spring
                 signal(minimum_available_buffer_reached);
                 signal(minimum_available_buffer_exceeded);
                 signal(caching_finished);
-                signal(cache_updated, std::size_t);
+                coalesced_signal(cache_updated, std::size_t);
 
             private:
             private:
@@ -77,6 +77,8 @@ namespace spring
                 std::weak_ptr<const music::Track> current_track_{};
                 bool buffering_finished_{ true };
                 bool minimum_available_buffer_exceeded_{ true };
+                /* When playback last ran out of data, in g_get_monotonic_time() microseconds */
+                std::int64_t starved_at_{ 0 };
 
             private:
                 DISABLE_COPY(Buffer)
@@ -54,9 +54,12 @@ namespace spring
             public:
                 signal(playback_state_changed, PlaybackState);
                 signal(playback_position_changed, Milliseconds);
-                signal(track_cache_updated, std::size_t);
+                coalesced_signal(track_cache_updated, std::size_t);
                 signal(track_cached);
 
+            private:
+                void set_gst_state(GstState state) noexcept;
+
             private:
                 static void gst_playback_finished(GstBus *bus,
                                                   GstMessage *message,
@@ -102,6 +105,7 @@ namespace spring
                 GstBus *bus_{ nullptr };
                 PlaybackState current_state_{ PlaybackState::Stopped };
                 GstState gst_state_{ GST_STATE_VOID_PENDING };
+                std::uint64_t state_change_flow_{ 0 };
 
                 playback::Buffer playback_buffer_{};
                 const playback::Playlist &playback_list_;
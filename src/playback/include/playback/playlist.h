@@ -50,7 +50,7 @@ namespace spring
                 signal(playback_position_changed, std::int64_t);
                 signal(track_queued, std::shared_ptr<music::Track> &);
                 signal(list_cleared);
-                signal(track_cache_updated, std::size_t);
+                coalesced_signal(track_cache_updated, std::size_t);
                 signal(track_cached);
 
             private:
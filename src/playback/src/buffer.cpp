@@ -1,6 +1,9 @@
 #include <cstring>
 
+#include <glib.h>
+
 #include <libspring_logger.h>
+#include <libspring_metrics.h>
 
 #include "playback/buffer.h"
 
@@ -18,6 +21,28 @@ namespace
     {
         return std::chrono::duration_cast<std::chrono::seconds>(value);
     };
+
+    struct buffer_metrics_t
+    {
+        metrics::Counter &sessions{ metrics::counter(
+            "spring_playback_buffering_sessions_total",
+            "Times a track started buffering, from the start or after a seek") };
+        metrics::Counter &rebuffers{ metrics::counter(
+            "spring_playback_rebuffers_total",
+            "Times playback ran out of buffered data before the track finished downloading") };
+        metrics::Counter &bytes{ metrics::counter("spring_playback_buffered_bytes_total",
+                                                  "Bytes of track data buffered for playback") };
+        metrics::Histogram &wait{ metrics::histogram(
+            "spring_playback_buffering_wait_seconds",
+            "Time spent waiting for enough data to start or resume playback",
+            metrics::latencyBuckets()) };
+    };
+
+    buffer_metrics_t &buffer_metrics() noexcept
+    {
+        static buffer_metrics_t instance{};
+        return instance;
+    }
 } // namespace
 
 Buffer::Producer::Producer() noexcept
@@ -118,6 +143,7 @@ Buffer::Buffer() noexcept
             std::unique_ptr<const char[]> buffer{ reinterpret_cast<const char *>(data) };
 
             self->buffer_.append(buffer.get(), size);
+            buffer_metrics().bytes.increment(size);
             auto new_size = self->buffer_.size();
             self->emit_cache_updated(std::move(new_size));
 
@@ -125,6 +151,8 @@ Buffer::Buffer() noexcept
             {
                 if (self->minimum_available_buffer_exceeded_)
                 {
+                    buffer_metrics().wait.observe((g_get_monotonic_time() - self->starved_at_) /
+                                                  1000000.0);
                     self->emit_minimum_available_buffer_reached();
                     self->minimum_available_buffer_exceeded_ = false;
                 }
@@ -171,6 +199,8 @@ void Buffer::start_caching(music::Track::Seconds offset) noexcept
         buffer_producer_.start_buffering(current_track_, offset);
 
         minimum_available_buffer_exceeded_ = true;
+        starved_at_ = g_get_monotonic_time();
+        buffer_metrics().sessions.increment();
         emit_minimum_available_buffer_exceeded();
     }
     else
@@ -191,6 +221,12 @@ const utility::string_view Buffer::consume(std::size_t count) noexcept
 
     if (!buffering_finished_ && buffer_.size() - consumed_ < MINIMUM_UNCONSUMED_BUFFER)
     {
+        if (!minimum_available_buffer_exceeded_)
+        {
+            starved_at_ = g_get_monotonic_time();
+            buffer_metrics().rebuffers.increment();
+        }
+
         emit_minimum_available_buffer_exceeded();
         minimum_available_buffer_exceeded_ = true;
     }
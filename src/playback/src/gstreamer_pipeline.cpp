@@ -4,6 +4,7 @@
 #include <gst/audio/audio.h>
 
 #include <libspring_logger.h>
+#include <libspring_trace.h>
 
 #include <gtk/gtk.h>
 
@@ -70,7 +71,7 @@ GStreamerPipeline::GStreamerPipeline(const Playlist &playback_list) noexcept
     playback_buffer_.on_minimum_available_buffer_reached(this, [](void *instance) {
         auto self = static_cast<GStreamerPipeline *>(instance);
         LOG_INFO("GStreamerPipeline({}): Minimum buffer reached", void_p(self));
-        gst_element_set_state(self->playbin_, GST_STATE_PLAYING);
+        self->set_gst_state(GST_STATE_PLAYING);
     });
 
     playback_buffer_.on_cache_updated(this, [](std::size_t new_size, void *instance) {
@@ -88,7 +89,7 @@ GStreamerPipeline::~GStreamerPipeline() noexcept
 {
     LOG_INFO("GStreamerPipeline({}): Destroying...", void_p(this));
 
-    gst_element_set_state(playbin_, GST_STATE_NULL);
+    set_gst_state(GST_STATE_NULL);
 
     playback_buffer_.disconnect_caching_finished(this);
     playback_buffer_.disconnect_cache_updated(this);
@@ -103,10 +104,10 @@ void GStreamerPipeline::play(const std::shared_ptr<const music::Track> &track) n
 {
     LOG_INFO("GStreamerPipeline({}): Playing {}", void_p(this), track->title());
 
-    gst_element_set_state(playbin_, GST_STATE_READY);
+    set_gst_state(GST_STATE_READY);
 
     playback_buffer_.set_track(track);
-    gst_element_set_state(playbin_, GST_STATE_PAUSED);
+    set_gst_state(GST_STATE_PAUSED);
 }
 
 void GStreamerPipeline::pause_resume() noexcept
@@ -116,12 +117,12 @@ void GStreamerPipeline::pause_resume() noexcept
     if (current_state_ == PlaybackState::Playing)
     {
         LOG_INFO("GStreamerPipeline({}): Pausing playback", void_p(this));
-        gst_element_set_state(playbin_, GST_STATE_PAUSED);
+        set_gst_state(GST_STATE_PAUSED);
     }
     else
     {
         LOG_INFO("GStreamerPipeline({}): Resuming playback", void_p(this));
-        gst_element_set_state(playbin_, GST_STATE_PLAYING);
+        set_gst_state(GST_STATE_PLAYING);
     }
 }
 
@@ -129,13 +130,23 @@ void GStreamerPipeline::stop() noexcept
 {
     LOG_INFO("GStreamerPipeline({}): Stop", void_p(this));
 
-    gst_element_set_state(playbin_, GST_STATE_NULL);
+    set_gst_state(GST_STATE_NULL);
     current_state_ = PlaybackState::Stopped;
 
     emit_playback_state_changed(PlaybackState::Stopped);
     emit_playback_position_changed(Milliseconds{ 0 });
 }
 
+void GStreamerPipeline::set_gst_state(GstState state) noexcept
+{
+    trace::Span span{ "gstreamer", "Set state" };
+    span.setDetail(gst_element_state_get_name(state));
+    /* Links the transition to the state-changed message handled once playbin gets there */
+    state_change_flow_ = span.flowOut();
+
+    gst_element_set_state(playbin_, state);
+}
+
 void GStreamerPipeline::seek(music::Track::Milliseconds count) noexcept
 {
     LOG_INFO("GStreamerPipeline({}): Seek to {}", void_p(this), count.count());
@@ -177,6 +188,11 @@ void GStreamerPipeline::gst_playback_state_changed(GstBus *,
 
         if (self->gst_state_ != gst_state)
         {
+            trace::Span span{ "gstreamer", "State changed" };
+            span.setDetail(gst_element_state_get_name(gst_state));
+            span.flowFrom(self->state_change_flow_);
+            self->state_change_flow_ = 0;
+
             PlaybackState new_state = self->gst_state_change_handlers_[gst_state](*self);
             self->gst_state_ = gst_state;
 
@@ -259,7 +275,7 @@ void GStreamerPipeline::gst_playback_error(GstBus *,
                                            GstMessage *message,
                                            GStreamerPipeline *self) noexcept
 {
-    gst_element_set_state(self->playbin_, GST_STATE_NULL);
+    self->set_gst_state(GST_STATE_NULL);
     gchar *error_message;
     gst_message_parse_error(message, nullptr, &error_message);
     LOG_ERROR("GStreamerPipeline({}): Internal: Playbin error: {}", void_p(self), error_message);
@@ -385,7 +401,7 @@ std::int32_t GStreamerPipeline::push_data_to_appsrc(GStreamerPipeline *self) noe
     }
     else
     {
-        gst_element_set_state(self->playbin_, GST_STATE_PAUSED);
+        self->set_gst_state(GST_STATE_PAUSED);
     }
 
     return result;
@@ -12,6 +12,8 @@
 #include "playback/playlist.h"
 
 #include "utility/async_queue.h"
+#include "utility/main_loop_watchdog.h"
+#include "utility/pack_store.h"
 #include "utility/settings.h"
 
 struct _SpringPlayer
@@ -58,6 +60,7 @@ static void spring_player_activate(GApplication *app)
     auto self = reinterpret_cast<SpringPlayer *>(app);
     if (self->main_window == nullptr)
     {
+        spring::player::utility::main_loop_watchdog::start();
         spring::player::utility::async_queue::start_processing();
 
         self->playback_list = std::make_shared<spring::player::playback::Playlist>();
@@ -71,6 +74,9 @@ static void spring_player_activate(GApplication *app)
 static void spring_player_shutdown(GApplication *app)
 {
     spring::player::utility::async_queue::stop_processing();
+    spring::player::utility::main_loop_watchdog::stop();
+    /* Keeps what was read recently from being the first to go next time */
+    spring::player::utility::PackStore::sync();
 
     auto self = reinterpret_cast<SpringPlayer *>(app);
     self->main_window.reset();
@@ -43,14 +43,14 @@ namespace spring
                 load_popular_tracks(const music::Artist &artist) const noexcept;
 
                 void on_tracks_loaded(
-                    std::vector<music::Track> *tracks,
-                    std::vector<utility::GObjectGuard<GtkBox>> *track_widgets) noexcept;
+                    std::vector<music::Track> &tracks,
+                    std::vector<utility::GObjectGuard<GtkBox>> &track_widgets) noexcept;
 
                 std::vector<ThumbnailWidget<music::Album>> *load_albums(
                     const music::Artist &artist) const noexcept;
 
                 void on_albums_loaded(
-                    std::vector<ThumbnailWidget<music::Album>> *album_widgets) noexcept;
+                    std::vector<ThumbnailWidget<music::Album>> &album_widgets) noexcept;
 
             private:
                 static void on_track_activated(GtkListBox *list_box,
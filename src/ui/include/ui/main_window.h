@@ -55,12 +55,17 @@ namespace spring
                 static void on_track_queued(std::shared_ptr<music::Track> &,
                                             MainWindow *self) noexcept;
                 static void on_new_connection_requested(MainWindow *self) noexcept;
+                static void on_music_section_changed(const std::string &old_key,
+                                                     const std::string &new_key,
+                                                     const std::string &server,
+                                                     MainWindow *self) noexcept;
 
             private:
                 bool switch_server(const std::vector<plex::Session> &sessions,
                                    const utility::string_view server_name) noexcept;
                 void show_welcome_page() noexcept;
                 void show_server_content() noexcept;
+                void verify_music_section(const std::string &section_key) noexcept;
 
             private:
                 GtkApplicationWindow *main_window_{ nullptr };
@@ -71,6 +76,8 @@ namespace spring
                 GtkSearchEntry *search_entry_{ nullptr };
 
                 PlexMediaServer pms_;
+                /* The server pms_ is connected to, section keys are stored by its name */
+                plex::Session session_{};
 
                 HeaderBar header_{ nullptr };
                 PlaylistSidebar playlist_sidebar_{ nullptr };
@@ -12,6 +12,7 @@
 /* TODO: Forward declare these */
 #include "ui/songs_page.h"
 
+#include "utility/artwork_prefetcher.h"
 #include "utility/forward_declarations.h"
 #include "utility/g_object_guard.h"
 #include "utility/settings.h"
@@ -55,6 +56,7 @@ namespace spring
                                                PageStack *self) noexcept;
                 static void on_artist_activated(ThumbnailWidget<music::Artist> *thumbnail,
                                                 PageStack *self) noexcept;
+                static void on_track_cache_updated(std::size_t size, PageStack *self) noexcept;
 
             private:
                 utility::GObjectGuard<GtkStack> page_stack_{ nullptr };
@@ -71,6 +73,8 @@ namespace spring
                 TrackListPopover track_list_popover_{ playback_list_ };
                 ArtistBrowsePage artist_browse_page_{ playback_list_ };
 
+                utility::ArtworkPrefetcher artwork_prefetcher_{};
+
             private:
                 DISABLE_COPY(PageStack)
                 DISABLE_MOVE(PageStack)
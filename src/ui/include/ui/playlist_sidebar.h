@@ -2,6 +2,7 @@
 #define SPRING_PLAYER_PLAYLIST_SIDEBAR_H
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 
 #include <libspring_global.h>
@@ -50,6 +51,12 @@ namespace spring
                                                                cairo_t *cairo_context,
                                                                PlaylistSidebar *self) noexcept;
 
+            private:
+                void load_artwork(std::shared_ptr<music::Track> track) noexcept;
+                void on_artwork_loaded(GdkPixbuf *image,
+                                       GdkPixbuf *background,
+                                       const utility::palette_t &palette) noexcept;
+
             private:
                 class PlaylistItem
                 {
@@ -62,6 +69,9 @@ namespace spring
                         const std::tuple<std::uint16_t, std::uint16_t, std::uint16_t>
                             &color) noexcept;
 
+                public:
+                    const std::shared_ptr<music::Track> &track() const noexcept;
+
                 public:
                     GtkWidget *operator()() noexcept;
 
@@ -87,6 +97,9 @@ namespace spring
                 std::unordered_map<GtkWidget *, std::unique_ptr<PlaylistItem>> playlist_{};
                 PlaylistItem *current_item_{ nullptr };
 
+                /* Dropped with the sidebar, which orphans artwork that is still loading */
+                std::shared_ptr<void> lifeline_{ std::make_shared<char>() };
+
             private:
                 DISABLE_COPY(PlaylistSidebar)
                 DISABLE_MOVE(PlaylistSidebar)
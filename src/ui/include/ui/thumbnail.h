@@ -5,6 +5,7 @@
 
 #include <libspring_global.h>
 
+#include "utility/color_palette.h"
 #include "utility/forward_declarations.h"
 
 namespace spring
@@ -40,22 +41,22 @@ namespace spring
                     std::uint8_t blue;
                 };
 
-                enum class BackgroundType
-                {
-                    Transparent,
-                    FromImage
-                };
-
             public:
                 Thumbnail() noexcept;
                 ~Thumbnail() noexcept;
 
             public:
-                void set_image(const std::string &data,
-                               BackgroundType background = BackgroundType::Transparent,
-                               size_t size = { { 200, 200 } }) noexcept;
+                /* Takes its own references, nothing is drawn unless both are set */
+                void set_image(GdkPixbuf *image, GdkPixbuf *background) noexcept;
+
+                /* A blurred copy of image to draw behind it, safe on any thread */
+                static GdkPixbuf *blurred_background(GdkPixbuf *image) noexcept;
+
+                /* Worked out off the main thread by whoever loads the image */
+                void set_palette(const utility::palette_t &palette) noexcept;
 
             public:
+                /* Of the last palette set, white if there was none */
                 pixel_t dominant_color() const noexcept;
 
             public:
@@ -71,6 +72,7 @@ namespace spring
                 GtkWidget *container_{ nullptr };
                 GdkPixbuf *image_{ nullptr };
                 GdkPixbuf *background_{ nullptr };
+                utility::palette_t palette_{};
 
             private:
                 DISABLE_COPY(Thumbnail)
@@ -18,6 +18,7 @@
 #include "utility/global.h"
 #include "utility/gtk_helpers.h"
 #include "utility/signals.h"
+#include "utility/startup_timer.h"
 
 namespace spring
 {
@@ -44,6 +45,9 @@ namespace spring
             public:
                 template <typename FetchFunction> void activated(FetchFunction &&f) noexcept;
                 void filter(std::string &&text) noexcept;
+                /* Empties the page, so the next activation loads it again. Content still */
+                /* being loaded for it is dropped when it arrives.                         */
+                void clear() noexcept;
 
             public:
                 void set_secondary_content_widget(GtkWidget *widget) noexcept;
@@ -56,6 +60,11 @@ namespace spring
             public:
                 GtkWidget *operator()() noexcept;
 
+            private:
+                using ContentList = std::vector<std::unique_ptr<ThumbnailWidget<ContentProvider>>>;
+                void populate(ContentList *content, std::uint32_t generation) noexcept;
+                void remove_children() noexcept;
+
             private:
                 static std::int32_t filter(GtkFlowBoxChild *child, void *self) noexcept;
                 static void on_child_activated(GtkFlowBox *,
@@ -71,7 +80,9 @@ namespace spring
                 utility::GObjectGuard<GtkWidget> secondary_content_page_{ nullptr };
 
                 std::weak_ptr<MusicLibrary> music_library_{};
-                std::vector<std::unique_ptr<ThumbnailWidget<ContentProvider>>> children_{};
+                ContentList children_{};
+                /* Bumped by clear(), loads started before that are stale */
+                std::uint32_t generation_{ 0 };
 
                 std::weak_ptr<playback::Playlist> playback_list_{};
 
@@ -38,29 +38,98 @@ void ThumbnailPage<ContentProvider>::activated(FetchFunction &&f) noexcept
     {
         gtk_spinner_start(loading_spinner_);
 
+        /* The fetch function is called twice, first to get whatever is available in the local */
+        /* snapshot so the page is populated without waiting for the server, then again to get */
+        /* the current listing. The second call returns nullptr if nothing changed.            */
         async_queue::push_front_request(async_queue::Request{
-            "load_content", [f, this]() {
-                LOG_INFO("ThumbnailPage({}): Loading content...", void_p(this));
-                auto r = f();
-                async_queue::post_response(async_queue::Response{
-                    "albums_ready", [this, r]() {
-                        LOG_INFO("ThumbnailPage({}): Content ready, populating GtkFlowBox",
-                                 void_p(this));
-
-                        children_ = std::move(*r);
-                        delete r;
-
-                        for (auto &widget : children_)
-                        {
-                            gtk_flow_box_insert(content_, (*widget)(), -1);
-                        }
-
-                        gtk_spinner_stop(loading_spinner_);
-                    } });
+            "load_content", [f, this, generation = generation_]() {
+                LOG_INFO("ThumbnailPage({}): Loading content from snapshot...", void_p(this));
+                auto snapshot = f(true);
+                if (snapshot != nullptr && !snapshot->empty())
+                {
+                    async_queue::post_response(async_queue::Response{
+                        "snapshot_ready",
+                        [this, snapshot, generation]() { populate(snapshot, generation); } });
+                }
+                else
+                {
+                    delete snapshot;
+                }
+
+                LOG_INFO("ThumbnailPage({}): Loading content from server...", void_p(this));
+                auto r = f(false);
+                if (r != nullptr)
+                {
+                    async_queue::post_response(async_queue::Response{
+                        "content_ready", [this, r, generation]() { populate(r, generation); } });
+                }
+                else
+                {
+                    async_queue::post_response(
+                        async_queue::Response{ "content_unchanged", [this, generation]() {
+                                                  if (generation == generation_)
+                                                  {
+                                                      gtk_spinner_stop(loading_spinner_);
+                                                  }
+                                              } });
+                }
             } });
     }
 }
 
+template <typename ContentProvider>
+void ThumbnailPage<ContentProvider>::populate(ContentList *content,
+                                              std::uint32_t generation) noexcept
+{
+    if (generation != generation_)
+    {
+        LOG_INFO("ThumbnailPage({}): Dropping content loaded before the page was cleared",
+                 void_p(this));
+        delete content;
+        return;
+    }
+
+    LOG_INFO("ThumbnailPage({}): Content ready, populating GtkFlowBox", void_p(this));
+
+    remove_children();
+
+    children_ = std::move(*content);
+    delete content;
+
+    for (auto &widget : children_)
+    {
+        gtk_flow_box_insert(content_, (*widget)(), -1);
+    }
+
+    gtk_spinner_stop(loading_spinner_);
+
+    if (!children_.empty())
+    {
+        startup_timer::content_visible("ThumbnailPage");
+    }
+}
+
+template <typename ContentProvider>
+void ThumbnailPage<ContentProvider>::clear() noexcept
+{
+    LOG_INFO("ThumbnailPage({}): Clearing", void_p(this));
+
+    ++generation_;
+    remove_children();
+    children_.clear();
+    gtk_spinner_stop(loading_spinner_);
+}
+
+template <typename ContentProvider>
+void ThumbnailPage<ContentProvider>::remove_children() noexcept
+{
+    for (auto &widget : children_)
+    {
+        gtk_container_remove(gtk_cast<GtkContainer>(content_),
+                             gtk_widget_get_parent((*widget)()));
+    }
+}
+
 template <typename ContentProvider>
 void ThumbnailPage<ContentProvider>::filter(std::string &&text) noexcept
 {
@@ -8,13 +8,12 @@
 #include <libspring_logger.h>
 #include <libspring_music_track.h>
 
+#include "utility/artwork_loader.h"
 #include "utility/async_queue.h"
-#include "utility/resource_cache.h"
 
 #include "utility/compatibility.h"
 #include "utility/global.h"
 #include "utility/gtk_helpers.h"
-#include "utility/pixbuf_loader.h"
 #include "utility/signals.h"
 
 namespace spring
@@ -54,6 +53,8 @@ namespace spring
                 ContentProvider content_provider_{ nullptr };
 
                 std::weak_ptr<playback::Playlist> playback_list_{};
+
+                std::shared_ptr<void> lifeline_{ std::make_shared<char>() };
             };
 
 #include "thumbnail_widget.tpp"
@@ -29,63 +29,45 @@ ThumbnailWidget<ContentProvider>::ThumbnailWidget(ContentProvider &&content_prov
     gtk_label_set_text(main_title_, main_text.data());
     gtk_label_set_text(secondary_title_, secondary_text.data());
 
-    std::string text{ secondary_text };
-
+    /* Artwork is loaded in device pixels, so it stays sharp on HiDPI screens */
+    const auto scale_factor = gtk_widget_get_scale_factor(gtk_cast<GtkWidget>(image_));
+
+    /* Artwork that is already shown elsewhere, or was recently, is set right away */
+    auto cached = cached_artwork<200, 200>(cache_prefix, content_provider_, scale_factor);
+    if (cached != nullptr)
+    {
+        set_image_from_artwork(image_, cached, scale_factor);
+        g_object_unref(cached);
+        return;
+    }
+
+    /* The request only holds a copy of the content and a weak reference to the widget, so */
+    /* the widget can be destroyed while its artwork is still being loaded                  */
+    std::weak_ptr<void> lifeline{ lifeline_ };
     async_queue::push_back_request(async_queue::Request{
-        "load_artwork", [this, cache_prefix, text] {
-            struct header_t
+        "load_artwork",
+        [this, lifeline, content_provider = content_provider_, cache_prefix, scale_factor] {
+            if (lifeline.expired())
             {
-                std::int32_t alpha;
-                std::int32_t bits_per_sample;
-                std::int32_t width;
-                std::int32_t height;
-                std::int32_t rowstride;
-            };
-
-            using cache_t = ResourceCache<5 * sizeof(header_t)>;
-            cache_t rc;
+                return;
+            }
 
-            auto result = rc.from_cache(cache_prefix, content_provider_.id());
-            if (result.second)
+            auto pixbuf = load_artwork<200, 200>(cache_prefix, content_provider, scale_factor);
+            if (pixbuf != nullptr)
             {
-                GdkPixbuf *pixbuf{ nullptr };
-
-                /* File is not cached, load it from the server and cache it */
-                if (!result.first)
-                {
-                    pixbuf = load_pixbuf_from_data_scaled<200, 200>(content_provider_.artwork());
-
-                    auto header = reinterpret_cast<header_t *>(result.first.header.data());
-                    header->alpha = gdk_pixbuf_get_has_alpha(pixbuf);
-                    header->bits_per_sample = gdk_pixbuf_get_bits_per_sample(pixbuf);
-                    header->width = gdk_pixbuf_get_width(pixbuf);
-                    header->height = gdk_pixbuf_get_height(pixbuf);
-                    header->rowstride = gdk_pixbuf_get_rowstride(pixbuf);
-                    guint size{ 0 };
-                    result.first.buffer.data = gdk_pixbuf_get_pixels_with_length(pixbuf, &size);
-                    result.first.buffer.size = size;
-
-                    rc.to_cache(cache_prefix, content_provider_.id(), result.first);
-                }
-                else /* File is cached and read, create a pixbuf out of it */
-                {
-                    auto header = reinterpret_cast<header_t *>(result.first.header.data());
-                    pixbuf = gdk_pixbuf_new_from_data(
-                        result.first.buffer.data, GDK_COLORSPACE_RGB, header->alpha,
-                        header->bits_per_sample, header->width, header->height, header->rowstride,
-                        [](guchar *data, void *) { delete[] data; }, nullptr);
-                }
-
-                async_queue::post_response(async_queue::Response{ "artwork_ready", [this, pixbuf] {
-                                                                     gtk_image_set_from_pixbuf(
-                                                                         image_, pixbuf);
-                                                                     g_object_unref(pixbuf);
-                                                                 } });
+                async_queue::post_response(async_queue::Response{
+                    "artwork_ready", [this, lifeline, pixbuf, scale_factor] {
+                        if (lifeline.lock() != nullptr)
+                        {
+                            set_image_from_artwork(image_, pixbuf, scale_factor);
+                        }
+                        g_object_unref(pixbuf);
+                    } });
             }
             else
             {
                 LOG_ERROR("ThumbnailWidget({}): Failed to grab artwork for {}", void_p(this),
-                          content_provider_.id());
+                          content_provider.id());
             }
         } });
 }
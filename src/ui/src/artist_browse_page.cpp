@@ -2,6 +2,8 @@
 #include <granite.h>
 #include <gtk/gtk.h>
 
+#include <memory>
+
 #include <fmt/format.h>
 
 #include <libspring_logger.h>
@@ -9,8 +11,8 @@
 #include "ui/artist_browse_page.h"
 
 #include "utility/async_queue.h"
+#include "utility/artwork_loader.h"
 #include "utility/global.h"
-#include "utility/pixbuf_loader.h"
 
 using namespace spring;
 using namespace spring::player;
@@ -45,85 +47,87 @@ void ArtistBrowsePage::set_artist(const music::Artist &artist) noexcept
 {
     clear_all();
 
-    /* TODO: Move this logic to a common place since it's used here and ThumbnailWidget */
-    async_queue::push_back_request(async_queue::Request{
-        "load_artwork", [this, &artist] {
-            struct header_t
-            {
-                std::int32_t alpha;
-                std::int32_t bits_per_sample;
-                std::int32_t width;
-                std::int32_t height;
-                std::int32_t rowstride;
-            };
-
-            using cache_t = ResourceCache<5 * sizeof(header_t)>;
-            cache_t rc;
-
-            auto cache_prefix = "artist_artwork";
-
-            auto result = rc.from_cache(cache_prefix, artist.id());
-            if (result.second)
-            {
-                GdkPixbuf *pixbuf{ nullptr };
+    /* Each of the requests below supersedes the one queued for the previously selected */
+    /* artist, so clicking through artists doesn't leave a backlog of stale loads        */
+    const auto scale_factor =
+        gtk_widget_get_scale_factor(gtk_cast<GtkWidget>(artist_thumbnail_));
+    auto cached = cached_artwork<200, 200>("artist_artwork", artist, scale_factor);
+    if (cached != nullptr)
+    {
+        set_image_from_artwork(artist_thumbnail_, cached, scale_factor);
+        g_object_unref(cached);
 
-                /* File is not cached, load it from the server and cache it */
-                if (!result.first)
+        /* Nothing to load, but the previous artist's artwork mustn't replace it either */
+        async_queue::push_back_request(
+            async_queue::Request{ "load_artwork", [] {}, "load_artwork_for_artist" });
+    }
+    else
+    {
+        async_queue::push_back_request(async_queue::Request{
+            "load_artwork",
+            [this, artist, scale_factor] {
+                auto pixbuf = load_artwork<200, 200>("artist_artwork", artist, scale_factor);
+                if (pixbuf != nullptr)
                 {
-                    pixbuf = load_pixbuf_from_data_scaled<200, 200>(artist.artwork());
-
-                    auto header = reinterpret_cast<header_t *>(result.first.header.data());
-                    header->alpha = gdk_pixbuf_get_has_alpha(pixbuf);
-                    header->bits_per_sample = gdk_pixbuf_get_bits_per_sample(pixbuf);
-                    header->width = gdk_pixbuf_get_width(pixbuf);
-                    header->height = gdk_pixbuf_get_height(pixbuf);
-                    header->rowstride = gdk_pixbuf_get_rowstride(pixbuf);
-                    guint size{ 0 };
-                    result.first.buffer.data = gdk_pixbuf_get_pixels_with_length(pixbuf, &size);
-                    result.first.buffer.size = size;
-
-                    rc.to_cache(cache_prefix, artist.id(), result.first);
+                    /* Released even if the response is dropped because the request was */
+                    /* superseded                                                       */
+                    std::shared_ptr<GdkPixbuf> image{ pixbuf,
+                                                      [](GdkPixbuf *p) { g_object_unref(p); } };
+                    async_queue::post_response(async_queue::Response{
+                        "artwork_ready", [this, image, scale_factor] {
+                            set_image_from_artwork(artist_thumbnail_, image.get(), scale_factor);
+                        } });
                 }
-                else /* File is cached and read, create a pixbuf out of it */
+                else
                 {
-                    auto header = reinterpret_cast<header_t *>(result.first.header.data());
-                    pixbuf = gdk_pixbuf_new_from_data(
-                        result.first.buffer.data, GDK_COLORSPACE_RGB, header->alpha,
-                        header->bits_per_sample, header->width, header->height, header->rowstride,
-                        [](guchar *data, void *) { delete[] data; }, nullptr);
+                    LOG_ERROR("ArtistBrowsePage({}): Failed to grab artwork for {}",
+                              void_p(this), artist.id());
                 }
-
-                async_queue::post_response(async_queue::Response{ "artwork_ready", [this, pixbuf] {
-                                                                     gtk_image_set_from_pixbuf(
-                                                                         artist_thumbnail_, pixbuf);
-                                                                     g_object_unref(pixbuf);
-                                                                 } });
-            }
-            else
-            {
-                LOG_ERROR("ArtistBrowsePage({}): Failed to grab artwork for {}", void_p(this),
-                          artist.id());
-            }
-        } });
+            },
+            "load_artwork_for_artist" });
+    }
 
     gtk_label_set_text(artist_name_, artist.name().c_str());
 
     gtk_spinner_start(popular_tracks_loading_spinner_);
     async_queue::push_front_request(async_queue::Request{
-        "load_popular_tracks_for_artist", [this, &artist] {
+        "load_popular_tracks_for_artist",
+        [this, artist] {
+            /* Once the widgets exist they're always handed to the main thread, which drops */
+            /* the reply if the request was superseded meanwhile, GTK objects can't be      */
+            /* destroyed anywhere else                                                      */
+            if (async_queue::cancelled())
+            {
+                return;
+            }
+
             auto tracks = load_popular_tracks(artist);
-            auto callback =
-                std::bind(&ArtistBrowsePage::on_tracks_loaded, this, tracks.first, tracks.second);
-            async_queue::post_response(async_queue::Response{ "tracks_ready", callback });
-        } });
+            std::shared_ptr<std::vector<music::Track>> track_list{ tracks.first };
+            std::shared_ptr<std::vector<GObjectGuard<GtkBox>>> track_widgets{ tracks.second };
+
+            async_queue::post_response(async_queue::Response{
+                "tracks_ready", [this, track_list, track_widgets] {
+                    on_tracks_loaded(*track_list, *track_widgets);
+                } });
+        },
+        "load_popular_tracks_for_artist" });
 
     gtk_spinner_start(album_list_loading_spinner_);
     async_queue::push_front_request(async_queue::Request{
-        "load_albums_for_artist", [this, &artist] {
-            auto albums = load_albums(artist);
-            auto callback = std::bind(&ArtistBrowsePage::on_albums_loaded, this, albums);
-            async_queue::post_response(async_queue::Response{ "tracks_ready", callback });
-        } });
+        "load_albums_for_artist",
+        [this, artist] {
+            if (async_queue::cancelled())
+            {
+                return;
+            }
+
+            std::shared_ptr<std::vector<ThumbnailWidget<music::Album>>> albums{ load_albums(
+                artist) };
+
+            async_queue::post_response(async_queue::Response{
+                "albums_ready", [this, albums] { on_albums_loaded(*albums); } });
+        },
+        "load_albums_for_artist" });
 }
 
 GtkWidget *ArtistBrowsePage::operator()() noexcept
@@ -180,22 +184,18 @@ ArtistBrowsePage::load_popular_tracks(const music::Artist &artist) const noexcep
 }
 
 void ArtistBrowsePage::on_tracks_loaded(
-    std::vector<music::Track> *tracks,
-    std::vector<utility::GObjectGuard<GtkBox>> *track_widgets) noexcept
+    std::vector<music::Track> &tracks,
+    std::vector<utility::GObjectGuard<GtkBox>> &track_widgets) noexcept
 {
     LOG_INFO("ArtistBrowsePage({}): Popular tracks ready for artist {}", void_p(this),
              gtk_label_get_text(artist_name_));
 
-    std::unique_ptr<std::vector<music::Track>> track_list{ tracks };
-    std::unique_ptr<std::vector<GObjectGuard<GtkBox>>> track_widget_list{ track_widgets };
-
     std::size_t index{ 0 };
-    for (auto &track_widget : *track_widget_list)
+    for (auto &track_widget : track_widgets)
     {
         gtk_container_add(gtk_cast<GtkContainer>(popular_tracks_listbox_),
                           gtk_cast<GtkWidget>(track_widget));
-        popular_tracks_.push_back(
-            std::make_shared<music::Track>(std::move(track_list->at(index++))));
+        popular_tracks_.push_back(std::make_shared<music::Track>(std::move(tracks.at(index++))));
     }
 
     gtk_spinner_stop(popular_tracks_loading_spinner_);
@@ -222,13 +222,12 @@ std::vector<ThumbnailWidget<music::Album>> *ArtistBrowsePage::load_albums(
 }
 
 void ArtistBrowsePage::on_albums_loaded(
-    std::vector<ThumbnailWidget<music::Album>> *album_widgets) noexcept
+    std::vector<ThumbnailWidget<music::Album>> &album_widgets) noexcept
 {
     LOG_INFO("ArtistBrowsePage({}): Albums ready for artist {}", void_p(this),
              gtk_label_get_text(artist_name_));
 
-    std::unique_ptr<std::vector<ThumbnailWidget<music::Album>>> album_widget_list{ album_widgets };
-    album_thumbnails_ = std::move(*album_widget_list);
+    album_thumbnails_ = std::move(album_widgets);
 
     for (auto &widget : album_thumbnails_)
     {
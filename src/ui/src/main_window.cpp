@@ -4,13 +4,16 @@
 #include <fmt/format.h>
 
 #include <libspring_logger.h>
+#include <libspring_metrics.h>
 
 #include "spring_player.h"
 
 #include "ui/main_window.h"
 
+#include "utility/async_queue.h"
 #include "utility/global.h"
 #include "utility/gtk_helpers.h"
+#include "utility/settings.h"
 
 using namespace spring;
 using namespace spring::player;
@@ -39,6 +42,37 @@ namespace
                                                   gtk_cast<GtkStyleProvider>(css_provider),
                                                   GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
     }
+
+    void on_frame_painted(GdkFrameClock *frame_clock, gpointer) noexcept
+    {
+        constexpr gint64 FRAME_BUDGET_US{ 16000 };
+
+        static auto &frame_duration = metrics::histogram(
+            "spring_ui_frame_duration_seconds",
+            "Time from the start of a frame until the main window finished painting it",
+            { 0.002, 0.004, 0.008, 0.016, 0.033, 0.066, 0.1, 0.25, 0.5 });
+        static auto &slow_frames = metrics::counter(
+            "spring_ui_slow_frames_total", "Frames that took longer than 16ms to produce");
+
+        const auto elapsed =
+            g_get_monotonic_time() - gdk_frame_clock_get_frame_time(frame_clock);
+        frame_duration.observe(elapsed / 1000000.0);
+        if (elapsed > FRAME_BUDGET_US)
+        {
+            slow_frames.increment();
+        }
+    }
+
+    void on_main_window_realized(GtkWidget *widget, gpointer) noexcept
+    {
+        /* A new frame clock comes with every realization, the old one is gone along with */
+        /* its handlers                                                                   */
+        auto frame_clock = gtk_widget_get_frame_clock(widget);
+        if (frame_clock != nullptr)
+        {
+            g_signal_connect(frame_clock, "after-paint", G_CALLBACK(&on_frame_painted), nullptr);
+        }
+    }
 } // namespace
 
 MainWindow::MainWindow(SpringPlayer &application, std::shared_ptr<Playlist> playback_list) noexcept
@@ -54,6 +88,8 @@ MainWindow::MainWindow(SpringPlayer &application, std::shared_ptr<Playlist> play
 
     get_widget_from_builder_simple(main_window);
     g_object_set(main_window_, "application", &application, nullptr);
+    async_queue::drain_responses_on_frame_clock(main_window_);
+    connect_g_signal(main_window_, "realize", &on_main_window_realized, this);
 
     get_widget_from_builder_simple(paned);
     get_widget_from_builder_simple(sidebar_placeholder);
@@ -164,6 +200,7 @@ void MainWindow::on_server_added(plex::Session session,
     session.save();
 
     self->pms_ = std::move(server);
+    self->session_ = std::move(session);
     self->show_server_content();
 }
 
@@ -203,6 +240,7 @@ bool MainWindow::switch_server(const std::vector<plex::Session> &sessions,
     {
         pms_.connect(it->hostname().c_str(), it->port(), it->token().c_str(),
                      PlexMediaServer::SSLErrorHandling::Acknowledge);
+        session_ = *it;
         result = true;
     }
 
@@ -217,8 +255,31 @@ void MainWindow::show_welcome_page() noexcept
 
 void MainWindow::show_server_content() noexcept
 {
-    page_stack_.set_music_library(
-        std::move(static_cast<MusicLibrary &>(pms_.sections().at(2).content())));
+    /* Listing the sections is a network round-trip, only wait for it when the music section */
+    /* is not known from a previous run                                                       */
+    auto section_key = settings::get_music_section(session_.name());
+    if (section_key.empty())
+    {
+        auto sections = pms_.sections();
+        auto it = std::find_if(sections.begin(), sections.end(), [](const LibrarySection &s) {
+            return s.type() == LibrarySection::Type::Music;
+        });
+
+        if (it == sections.end())
+        {
+            LOG_ERROR("MainWindow({}): No music library found on {}", void_p(this), pms_.name());
+            return;
+        }
+
+        section_key = it->key();
+        settings::set_music_section(session_.name(), section_key);
+    }
+    else
+    {
+        verify_music_section(section_key);
+    }
+
+    page_stack_.set_music_library(pms_.musicLibrary(section_key));
 
     header_.show_controls();
     gtk_widget_hide(welcome_page_());
@@ -230,3 +291,72 @@ void MainWindow::show_server_content() noexcept
 
     gtk_box_pack_end(main_content_, page_stack_(), true, true, 0);
 }
+
+void MainWindow::verify_music_section(const std::string &section_key) noexcept
+{
+    /* A section from a previous run may have been deleted or recreated under a new key since, */
+    /* look for it again in the background and reload the library if it's gone                 */
+    async_queue::push_request(
+        async_queue::Priority::Background,
+        async_queue::Request{ "verify_music_section", [this, section_key, session = session_] {
+                                 /* A connection of its own, pms_ is only used on the main thread */
+                                 PlexMediaServer server;
+                                 server.connect(session.hostname().c_str(), session.port(),
+                                                session.token().c_str(),
+                                                PlexMediaServer::SSLErrorHandling::Acknowledge);
+
+                                 auto sections = server.sections();
+                                 if (sections.empty())
+                                 {
+                                     /* Most likely offline, keep using the stored section */
+                                     return;
+                                 }
+
+                                 std::string music_section{};
+                                 for (const auto &s : sections)
+                                 {
+                                     if (s.type() != LibrarySection::Type::Music)
+                                     {
+                                         continue;
+                                     }
+                                     if (s.key() == section_key)
+                                     {
+                                         return;
+                                     }
+                                     if (music_section.empty())
+                                     {
+                                         music_section = s.key();
+                                     }
+                                 }
+
+                                 async_queue::post_response(async_queue::Response{
+                                     "music_section_changed",
+                                     [this, section_key, music_section, server = session.name()] {
+                                         on_music_section_changed(section_key, music_section,
+                                                                  server, this);
+                                     } });
+                             } });
+}
+
+void MainWindow::on_music_section_changed(const std::string &old_key,
+                                          const std::string &new_key,
+                                          const std::string &server,
+                                          MainWindow *self) noexcept
+{
+    if (server != self->session_.name())
+    {
+        return;
+    }
+
+    LOG_WARN("MainWindow({}): Music section {} no longer exists on {}", void_p(self), old_key,
+             server);
+
+    settings::set_music_section(server, new_key);
+    if (new_key.empty())
+    {
+        LOG_ERROR("MainWindow({}): No music library found on {}", void_p(self), server);
+        return;
+    }
+
+    self->page_stack_.set_music_library(self->pms_.musicLibrary(new_key));
+}
@@ -1,5 +1,7 @@
 #include <gtk/gtk.h>
 
+#include <fmt/format.h>
+
 #include <libspring_logger.h>
 
 #include "ui/artist_browse_page.h"
@@ -15,6 +17,44 @@ using namespace spring::player::ui;
 using namespace spring::player::playback;
 using namespace spring::player::utility;
 
+namespace
+{
+    /* What a page shows for every item, so that a title or artwork change on the server */
+    /* refreshes the page as well                                                         */
+    std::string fingerprint(const music::Album &album) noexcept
+    {
+        return fmt::format("{}\n{}\n{}\n{}", album.id(), album.title(), album.artist(),
+                           album.artworkPath());
+    }
+
+    std::string fingerprint(const music::Artist &artist) noexcept
+    {
+        return fmt::format("{}\n{}\n{}", artist.id(), artist.name(), artist.artworkPath());
+    }
+
+    /* Records what a page was last populated with, so that a listing fetched from the server */
+    /* that matches the snapshot already on screen does not rebuild every widget              */
+    template <typename Content>
+    bool listing_changed(const std::vector<Content> &content,
+                         std::vector<std::string> &listed) noexcept
+    {
+        std::vector<std::string> current{};
+        current.reserve(content.size());
+        for (const auto &c : content)
+        {
+            current.push_back(fingerprint(c));
+        }
+
+        if (current == listed)
+        {
+            return false;
+        }
+
+        listed = std::move(current);
+        return true;
+    }
+} // namespace
+
 PageStack::PageStack(PageStackSwitcher &stack_switcher,
                      std::weak_ptr<Playlist> playback_list) noexcept
   : page_stack_{ gtk_cast<GtkStack>(gtk_stack_new()) }
@@ -40,17 +80,39 @@ PageStack::PageStack(PageStackSwitcher &stack_switcher,
     albums_page_.on_thumbnail_activated(this, &on_album_activated);
     artists_page_.on_thumbnail_activated(this, &on_artist_activated);
     artists_page_.set_secondary_content_widget(artist_browse_page_());
+
+    auto playlist = playback_list_.lock();
+    if (playlist != nullptr)
+    {
+        playlist->on_track_cache_updated(this, &on_track_cache_updated);
+    }
 }
 
 PageStack::~PageStack() noexcept
 {
     LOG_INFO("PageStack({}): Destroying...", void_p(this));
+
+    auto playlist = playback_list_.lock();
+    if (playlist != nullptr)
+    {
+        playlist->disconnect_track_cache_updated(this);
+    }
 }
 
 void PageStack::set_music_library(MusicLibrary &&library) noexcept
 {
+    /* Whatever the pages show belongs to the previous library, e.g. another server or */
+    /* music section, and they wouldn't load anything while they aren't empty          */
+    albums_page_.clear();
+    artists_page_.clear();
+    artists_page_.switch_to_primary_page();
+
     music_library_ = std::make_shared<MusicLibrary>(std::move(library));
+    music_library_->enableSnapshots(settings::cache_directory());
     on_page_requested(settings::get_current_page(), this);
+
+    artwork_prefetcher_.start(music_library_,
+                              gtk_widget_get_scale_factor(gtk_cast<GtkWidget>(page_stack_)));
 }
 
 void PageStack::filter_current_page(std::string &&text) noexcept
@@ -81,19 +143,33 @@ void PageStack::on_page_requested(PageStack::Page page, PageStack *self) noexcep
     auto &albums_page = self->albums_page_;
     auto &artists_page = self->artists_page_;
     auto playback_list = self->playback_list_;
+    /* Held by value, music_library_ is replaced on the main thread while requests run */
+    auto music_library = self->music_library_;
+    /* What the page shows, fresh for every activation and so for every library */
+    auto listed = std::make_shared<std::vector<std::string>>();
 
     switch (page)
     {
         case Page::Albums:
             gtk_stack_set_visible_child(self->page_stack_, albums_page());
-            self->albums_page_.activated([self, playback_list]() {
+            self->albums_page_.activated([self, playback_list, music_library,
+                                          listed](bool from_snapshot) {
                 using AlbumWidget = ThumbnailWidget<music::Album>;
 
-                auto album_widgets = new std::vector<std::unique_ptr<AlbumWidget>>{};
+                std::vector<std::unique_ptr<AlbumWidget>> *album_widgets{ nullptr };
 
-                if (self->music_library_ != nullptr)
+                if (music_library != nullptr)
                 {
-                    auto albums = self->music_library_->albums();
+                    Error error{};
+                    auto albums = from_snapshot ? music_library->cachedAlbums()
+                                                : music_library->albums(&error);
+                    /* Whatever is on screen is better than an empty page */
+                    if (error || !listing_changed(albums, *listed))
+                    {
+                        return album_widgets;
+                    }
+
+                    album_widgets = new std::vector<std::unique_ptr<AlbumWidget>>{};
                     album_widgets->reserve(albums.size());
 
                     std::string main_text;
@@ -121,11 +197,37 @@ void PageStack::on_page_requested(PageStack::Page page, PageStack *self) noexcep
             break;
         case Page::Artists:
             gtk_stack_set_visible_child(self->page_stack_, artists_page());
-            self->artists_page_.activated([self, playback_list]() {
+            self->artists_page_.activated([self, playback_list, music_library,
+                                           listed](bool from_snapshot) {
                 using ArtistWidget = ThumbnailWidget<music::Artist>;
 
-                auto artists = self->music_library_->artists();
-                auto artist_widgets = new std::vector<std::unique_ptr<ArtistWidget>>{};
+                std::vector<std::unique_ptr<ArtistWidget>> *artist_widgets{ nullptr };
+
+                if (music_library == nullptr)
+                {
+                    LOG_WARN("PageStack({}): Music library is null, failed to load content",
+                             void_p(self));
+                    return artist_widgets;
+                }
+
+                Error error{};
+                auto artists = from_snapshot ? music_library->cachedArtists()
+                                             : music_library->artists(&error);
+                if (error || !listing_changed(artists, *listed))
+                {
+                    return artist_widgets;
+                }
+
+                const auto summaries = from_snapshot ? music_library->cachedArtistSummaries() :
+                                                       music_library->artistSummaries(&error);
+                if (error)
+                {
+                    /* Try again on the next refresh, rather than drop the album counts */
+                    listed->clear();
+                    return artist_widgets;
+                }
+
+                artist_widgets = new std::vector<std::unique_ptr<ArtistWidget>>{};
                 artist_widgets->reserve(artists.size());
 
                 std::string main_text;
@@ -134,10 +236,18 @@ void PageStack::on_page_requested(PageStack::Page page, PageStack *self) noexcep
                 for (auto &artist : artists)
                 {
                     main_text = artist.name();
-                    //                    auto albums = artist.albums();
-                    //                    auto album_count = albums.size();
-                    //                    secondary_text =
-                    //                        fmt::format("{} {}", album_count, album_count > 1 ? "albums" : "album");
+
+                    auto summary = summaries.find(artist.id());
+                    if (summary != summaries.end())
+                    {
+                        const auto album_count = summary->second.albumCount;
+                        secondary_text = fmt::format("{} {}", album_count,
+                                                     album_count > 1 ? "albums" : "album");
+                    }
+                    else
+                    {
+                        secondary_text.clear();
+                    }
 
                     artist_widgets->push_back(
                         std::make_unique<ArtistWidget>(std::move(artist), main_text, secondary_text,
@@ -168,3 +278,9 @@ void PageStack::on_artist_activated(ThumbnailWidget<music::Artist> *thumbnail,
     self->artist_browse_page_.set_artist(thumbnail->content_provider());
     self->artists_page_.switch_to_secondary_page();
 }
+
+void PageStack::on_track_cache_updated(std::size_t, PageStack *self) noexcept
+{
+    /* The track that is buffering gets the bandwidth */
+    self->artwork_prefetcher_.hold_off();
+}
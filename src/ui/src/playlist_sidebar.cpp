@@ -9,8 +9,12 @@
 
 #include "playback/playlist.h"
 
+#include "utility/artwork_loader.h"
+#include "utility/async_queue.h"
+#include "utility/content_hash.h"
 #include "utility/global.h"
 #include "utility/gtk_helpers.h"
+#include "utility/pixbuf_loader.h"
 
 using namespace spring;
 using namespace spring::player;
@@ -36,6 +40,22 @@ namespace
 
         return text_color;
     }
+
+    /* Worked out the first time the artwork is shown, read back from the cache after that. */
+    /* Hashes the whole image, so it's kept off the main thread.                            */
+    palette_t track_artwork_palette(const std::string &data, GdkPixbuf *image) noexcept
+    {
+        artwork::cache_t rc;
+        const auto hash = content_hash(data.data(), data.size());
+
+        auto cached = artwork::cached_palette(rc, "track_artwork", hash);
+        if (cached.second)
+        {
+            return cached.first;
+        }
+
+        return artwork::artwork_palette(rc, "track_artwork", hash, image);
+    }
 } // namespace
 
 PlaylistSidebar::PlaylistSidebar(std::shared_ptr<Playlist> playback_list) noexcept
@@ -90,6 +110,7 @@ PlaylistSidebar::PlaylistSidebar(std::shared_ptr<Playlist> playback_list) noexce
                                   nullptr);
 
             self->playlist_.clear();
+            self->current_item_ = nullptr;
         },
         this);
 
@@ -187,25 +208,9 @@ void PlaylistSidebar::on_playback_state_changed(Playlist::PlaybackState new_stat
                     }
                     self->current_item_ = it->second.get();
                     it->second->set_playing(true);
-                }
-
-                const auto &artwork = current_track.second->artwork();
-                self->artwork_.set_image(artwork, Thumbnail::BackgroundType::FromImage);
-                gtk_widget_queue_draw(gtk_cast<GtkWidget>(self->track_list_container_));
 
-                auto background_color = self->artwork_.dominant_color();
-
-                for (auto &track_item : self->playlist_)
-                {
-                    track_item.second->set_text_color(determine_text_color(background_color));
+                    self->load_artwork(it->second->track());
                 }
-
-                GdkRGBA gdk_color{ static_cast<gdouble>(background_color.red) / 255,
-                                   static_cast<gdouble>(background_color.green) / 255,
-                                   static_cast<gdouble>(background_color.blue) / 255, 0.8 };
-                gtk_widget_override_background_color(
-                    gtk_cast<GtkWidget>(self->track_list_container_), GTK_STATE_FLAG_NORMAL,
-                    &gdk_color);
             }
         }
         else
@@ -224,6 +229,78 @@ std::int32_t PlaylistSidebar::on_list_box_draw_requested(GtkWidget *,
     return false;
 }
 
+void PlaylistSidebar::load_artwork(std::shared_ptr<music::Track> track) noexcept
+{
+    /* Fetching, decoding and blurring the artwork and reading or writing its palette all */
+    /* stay off the main thread. Superseded when the track changes again before it's done. */
+    std::weak_ptr<void> lifeline{ lifeline_ };
+    async_queue::push_request(
+        async_queue::Priority::Visible,
+        async_queue::Request{
+            "load_track_artwork",
+            [this, lifeline, track] {
+                if (lifeline.expired())
+                {
+                    return;
+                }
+
+                const auto artwork = track->artwork();
+                auto pixbuf = load_pixbuf_from_data_scaled<200, 200>(artwork);
+                if (pixbuf == nullptr)
+                {
+                    LOG_ERROR("PlaylistSidebar({}): Failed to decode artwork for {}",
+                              void_p(this), track->title());
+                    return;
+                }
+
+                /* Released on the main thread even if the response is dropped because the */
+                /* request was superseded                                                  */
+                const auto unref = [](GdkPixbuf *p) { g_object_unref(p); };
+                std::shared_ptr<GdkPixbuf> image{ pixbuf, unref };
+                std::shared_ptr<GdkPixbuf> background{ Thumbnail::blurred_background(pixbuf),
+                                                       unref };
+                if (background == nullptr)
+                {
+                    return;
+                }
+
+                const auto palette = track_artwork_palette(artwork, pixbuf);
+
+                async_queue::post_response(async_queue::Response{
+                    "track_artwork_ready", [this, lifeline, track, image, background, palette] {
+                        /* Only shown if the track is still the one playing */
+                        if (lifeline.lock() != nullptr && current_item_ != nullptr &&
+                            current_item_->track() == track)
+                        {
+                            on_artwork_loaded(image.get(), background.get(), palette);
+                        }
+                    } });
+            },
+            "load_track_artwork" });
+}
+
+void PlaylistSidebar::on_artwork_loaded(GdkPixbuf *image,
+                                        GdkPixbuf *background,
+                                        const palette_t &palette) noexcept
+{
+    artwork_.set_image(image, background);
+    artwork_.set_palette(palette);
+    gtk_widget_queue_draw(gtk_cast<GtkWidget>(track_list_container_));
+
+    auto background_color = artwork_.dominant_color();
+
+    for (auto &track_item : playlist_)
+    {
+        track_item.second->set_text_color(determine_text_color(background_color));
+    }
+
+    GdkRGBA gdk_color{ static_cast<gdouble>(background_color.red) / 255,
+                       static_cast<gdouble>(background_color.green) / 255,
+                       static_cast<gdouble>(background_color.blue) / 255, 0.8 };
+    gtk_widget_override_background_color(gtk_cast<GtkWidget>(track_list_container_),
+                                         GTK_STATE_FLAG_NORMAL, &gdk_color);
+}
+
 PlaylistSidebar::PlaylistItem::PlaylistItem(std::shared_ptr<music::Track> &track) noexcept
   : track_(track)
 {
@@ -266,6 +343,11 @@ void PlaylistSidebar::PlaylistItem::set_text_color(
     pango_attr_list_unref(attributes);
 }
 
+const std::shared_ptr<music::Track> &PlaylistSidebar::PlaylistItem::track() const noexcept
+{
+    return track_;
+}
+
 GtkWidget *PlaylistSidebar::PlaylistItem::operator()() noexcept
 {
     return gtk_cast<GtkWidget>(playlist_item_);
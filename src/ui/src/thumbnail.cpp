@@ -1,7 +1,5 @@
 ﻿#include <chrono>
-#include <cstring>
 #include <memory>
-#include <unordered_map>
 
 #include <cairo.h>
 #include <gtk/gtk.h>
@@ -13,37 +11,13 @@
 #include "utility/exponential_blur.h"
 #include "utility/global.h"
 #include "utility/gtk_helpers.h"
-#include "utility/pixbuf_loader.h"
+#include "utility/main_loop_watchdog.h"
 
 using namespace spring;
 using namespace spring::player;
 using namespace spring::player::ui;
 using namespace spring::player::utility;
 
-namespace
-{
-    struct hash_pixel
-    {
-        std::size_t operator()(const Thumbnail::pixel_t &pixel) const noexcept
-        {
-            auto hash = std::hash<std::int32_t>{};
-            return hash(255 - static_cast<std::int32_t>(pixel.red) +
-                        static_cast<std::int32_t>(pixel.green) +
-                        static_cast<std::int32_t>(pixel.blue) * 2);
-        }
-    };
-
-    struct eq_pixel
-    {
-        bool operator()(const Thumbnail::pixel_t &first, const Thumbnail::pixel_t &second) const
-            noexcept
-        {
-            return (first.red == second.red) && (first.green == second.green) &&
-                   (first.blue == second.blue);
-        }
-    };
-} // namespace
-
 Thumbnail::Thumbnail() noexcept
   : container_(gtk_drawing_area_new())
 {
@@ -68,9 +42,7 @@ Thumbnail::~Thumbnail() noexcept
     gtk_widget_destroy(container_);
 }
 
-void Thumbnail::set_image(const std::string &data,
-                          Thumbnail::BackgroundType background,
-                          size_t size) noexcept
+void Thumbnail::set_image(GdkPixbuf *image, GdkPixbuf *background) noexcept
 {
     if (background_ != nullptr)
     {
@@ -82,99 +54,46 @@ void Thumbnail::set_image(const std::string &data,
         g_object_unref(image_);
     }
 
-    const auto start = std::chrono::high_resolution_clock::now();
-    auto thumbnail = utility::load_pixbuf_from_data(data);
-    image_ = gdk_pixbuf_scale_simple(thumbnail, size.width, size.height, GDK_INTERP_TILES);
+    image_ = image != nullptr ? GDK_PIXBUF(g_object_ref(image)) : nullptr;
+    background_ = background != nullptr ? GDK_PIXBUF(g_object_ref(background)) : nullptr;
 
-    if (background == Thumbnail::BackgroundType::FromImage)
+    if (image_ != nullptr)
     {
-        background_ = gdk_pixbuf_copy(image_);
-
-        auto channels = gdk_pixbuf_get_n_channels(background_);
-        auto pixels = gdk_pixbuf_get_pixels(background_);
-        const size_t size{ { gdk_pixbuf_get_width(background_),
-                             gdk_pixbuf_get_height(background_) } };
-        const auto radius{ 5 };
+        gtk_widget_set_size_request(container_, gdk_pixbuf_get_width(image_),
+                                    gdk_pixbuf_get_height(image_));
+    }
+    gtk_widget_queue_draw(container_);
+}
 
-        if (channels == 3)
-        {
-            exponential_blur<3>(pixels, size.width, size.height, radius);
-        }
-        else
-        {
-            exponential_blur<4>(pixels, size.width, size.height, radius);
-        }
+GdkPixbuf *Thumbnail::blurred_background(GdkPixbuf *image) noexcept
+{
+    auto background = gdk_pixbuf_copy(image);
+    if (background == nullptr)
+    {
+        return background;
     }
 
-    g_object_unref(thumbnail);
+    const auto radius{ 5 };
+    exponential_blur(gdk_pixbuf_get_pixels(background), gdk_pixbuf_get_width(background),
+                     gdk_pixbuf_get_height(background), gdk_pixbuf_get_rowstride(background),
+                     gdk_pixbuf_get_n_channels(background), radius);
 
-    const auto end = std::chrono::high_resolution_clock::now();
-    LOG_INFO("Loading image took: {}ms",
-             std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    return background;
+}
 
-    gtk_widget_set_size_request(container_, size.width, size.height);
-    gtk_widget_queue_draw(container_);
+void Thumbnail::set_palette(const utility::palette_t &palette) noexcept
+{
+    palette_ = palette;
 }
 
 Thumbnail::pixel_t Thumbnail::dominant_color() const noexcept
 {
     pixel_t result{ 255, 255, 255 };
 
-    if (image_ != nullptr)
+    if (palette_.size > 0)
     {
-        std::unordered_map<pixel_t, std::int32_t, hash_pixel, eq_pixel> colors;
-
-        std::int32_t count{ 0 };
-        auto channel_count = static_cast<std::size_t>(gdk_pixbuf_get_n_channels(image_));
-
-        constexpr std::size_t sample_offset{ 3 };
-        constexpr std::uint8_t top_threshold{ 235 };
-        constexpr std::uint8_t bottom_threshold{ 30 };
-
-        const auto length = static_cast<std::size_t>(gdk_pixbuf_get_width(image_)) *
-                            static_cast<std::size_t>(gdk_pixbuf_get_height(image_)) * channel_count;
-        for (std::size_t y = 0; y < length; y += channel_count * sample_offset)
-        {
-            auto pixel = *reinterpret_cast<pixel_t *>(gdk_pixbuf_get_pixels(image_) + y);
-
-            if ((pixel.red > top_threshold && pixel.green > top_threshold) ||
-                (pixel.red > top_threshold && pixel.blue > top_threshold) ||
-                (pixel.blue > top_threshold && pixel.green > top_threshold))
-            {
-                continue;
-            }
-
-            if ((pixel.red < bottom_threshold && pixel.green < bottom_threshold) ||
-                (pixel.red < bottom_threshold && pixel.blue < bottom_threshold) ||
-                (pixel.blue < bottom_threshold && pixel.green < bottom_threshold))
-            {
-                continue;
-            }
-
-            pixel.red /= 10;
-            pixel.red *= 10;
-
-            pixel.green /= 10;
-            pixel.green *= 10;
-
-            pixel.blue /= 10;
-            pixel.blue *= 10;
-
-            auto it = colors.find(pixel);
-            if (it != colors.end())
-            {
-                ++(it->second);
-                if (it->second > count)
-                {
-                    count = it->second;
-                    result = it->first;
-                }
-            }
-            else
-            {
-                colors.insert({ pixel, 1 });
-            }
-        }
+        const auto &color = palette_.colors[0];
+        result = { color.red, color.green, color.blue };
     }
 
     return result;
@@ -194,8 +113,10 @@ std::int32_t Thumbnail::on_draw_requested(GtkWidget *,
                                           cairo_t *cairo_context,
                                           Thumbnail *self) noexcept
 {
+    main_loop_watchdog::Activity activity{ "Thumbnail::on_draw_requested" };
+
     const auto start = std::chrono::high_resolution_clock::now();
-    if (self->image_ != nullptr)
+    if (self->image_ != nullptr && self->background_ != nullptr)
     {
         const size_t container_size{ { gtk_widget_get_allocated_width(self->container_),
                                        gtk_widget_get_allocated_height(self->container_) } };
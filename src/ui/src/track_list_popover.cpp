@@ -40,7 +40,7 @@ void TrackListPopover::show(const music::Album &album, GtkWidget *relative_to) n
     gtk_spinner_start(loading_spinner_);
 
     async_queue::push_front_request(async_queue::Request{
-        "load_tracks_for_album", [this, &album] {
+        "load_tracks_for_album", [this, album] {
             auto tracks = load_tracks(album);
             auto callback =
                 std::bind(&TrackListPopover::on_tracks_loaded, this, tracks.first, tracks.second);
@@ -0,0 +1,584 @@
+#ifndef SPRING_PLAYER_UTILITY_ARTWORK_LOADER_H
+#define SPRING_PLAYER_UTILITY_ARTWORK_LOADER_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+#include <fmt/format.h>
+
+#include <libspring_logger.h>
+#include <libspring_metrics.h>
+#include <libspring_trace.h>
+
+#include "utility/color_palette.h"
+#include "utility/compatibility.h"
+#include "utility/content_hash.h"
+#include "utility/pixbuf_cache.h"
+#include "utility/pixbuf_loader.h"
+#include "utility/qoi_codec.h"
+#include "utility/resource_cache.h"
+#include "utility/settings.h"
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            namespace artwork
+            {
+                enum class Encoding : std::int32_t
+                {
+                    Raw,      /* Pixels as laid out by the pixbuf */
+                    Qoi,      /* Compressed with qoi::encode */
+                    Reference, /* No pixels, the artwork is cached under level_id() */
+                    Palette    /* No pixels, only the palette of the content */
+                };
+
+                /* Changed whenever header_t or the meaning of its fields does. Anything cached */
+                /* with another value, or before there was one, is treated as not cached.      */
+                constexpr std::uint32_t HEADER_MAGIC{ 0x31525053 }; /* "SPR1" */
+
+                struct header_t
+                {
+                    std::uint32_t magic;
+                    std::int32_t alpha;
+                    std::int32_t bits_per_sample;
+                    std::int32_t width;
+                    std::int32_t height;
+                    std::int32_t rowstride;
+                    Encoding encoding;
+                    /* content_hash() of the downloaded image */
+                    std::uint64_t content_hash;
+                    /* Only set in Palette entries */
+                    palette_t palette;
+                };
+
+                /* Fixed so header_t can grow without changing the record layout */
+                constexpr std::size_t HEADER_LENGTH{ 100 };
+                static_assert(sizeof(header_t) <= HEADER_LENGTH, "header_t too large");
+
+                using cache_t = ResourceCache<HEADER_LENGTH>;
+
+                /* The header of a cached resource, nullptr if nothing was cached or if it was */
+                /* cached in another format                                                    */
+                inline const header_t *header_of(const cache_t::Resource &resource) noexcept
+                {
+                    auto header = reinterpret_cast<const header_t *>(resource.header.data());
+                    if (!resource || header->magic != HEADER_MAGIC)
+                    {
+                        return nullptr;
+                    }
+
+                    return header;
+                }
+
+                /* Starts the header of a resource about to be cached */
+                inline header_t *new_header(cache_t::Resource &resource) noexcept
+                {
+                    auto header = reinterpret_cast<header_t *>(resource.header.data());
+                    header->magic = HEADER_MAGIC;
+                    return header;
+                }
+
+                /* Sizes artwork is cached in, each one half the next. A view gets the smallest */
+                /* level that covers its size in device pixels, resampled to fit exactly.      */
+                constexpr std::array<int, 4> LEVELS{ { 64, 128, 256, 512 } };
+
+                inline int level_for(int width, int height) noexcept
+                {
+                    const auto size = std::max(width, height);
+                    for (auto level : LEVELS)
+                    {
+                        if (level >= size)
+                        {
+                            return level;
+                        }
+                    }
+
+                    return LEVELS.back();
+                }
+
+                /* Artwork is identified by the hash of the downloaded image and stored once, */
+                /* at every level, no matter how many resources it belongs to. Resources only */
+                /* hold a Reference to it.                                                   */
+                inline std::string content_id(std::uint64_t content_hash) noexcept
+                {
+                    return fmt::format("content-{:016x}", content_hash);
+                }
+
+                inline std::string level_id(std::uint64_t content_hash, int level) noexcept
+                {
+                    return fmt::format("{}-{}", content_id(content_hash), level);
+                }
+
+                /* Different sizes of the same artwork are different pixbufs */
+                inline std::string pixbuf_cache_key(string_view cache_prefix,
+                                                    string_view id,
+                                                    int width,
+                                                    int height) noexcept
+                {
+                    return fmt::format("{}/{}/{}x{}", cache_prefix, id, width, height);
+                }
+
+                /* Returns a new reference to `pixbuf` at exactly width x height */
+                inline GdkPixbuf *resample(GdkPixbuf *pixbuf, int width, int height) noexcept
+                {
+                    if (gdk_pixbuf_get_width(pixbuf) == width &&
+                        gdk_pixbuf_get_height(pixbuf) == height)
+                    {
+                        return GDK_PIXBUF(g_object_ref(pixbuf));
+                    }
+
+                    TRACE_SPAN("pixbuf", "Resample");
+
+                    return gdk_pixbuf_scale_simple(pixbuf, width, height, GDK_INTERP_HYPER);
+                }
+
+                /* Creates a pixbuf out of a cached resource, nullptr if it can't be decoded */
+                inline GdkPixbuf *pixbuf_from_cache(const cache_t::Resource &resource) noexcept
+                {
+                    static auto &raw_duration = metrics::histogram(
+                        "spring_artwork_cache_decode_seconds",
+                        "Time to turn cached artwork into a pixbuf",
+                        { 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01 },
+                        "encoding=\"raw\"");
+                    static auto &qoi_duration = metrics::histogram(
+                        "spring_artwork_cache_decode_seconds",
+                        "Time to turn cached artwork into a pixbuf",
+                        { 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01 },
+                        "encoding=\"qoi\"");
+
+                    TRACE_SPAN("pixbuf", "Decode cached");
+
+                    const auto started_at = g_get_monotonic_time();
+                    auto header = header_of(resource);
+
+                    GdkPixbuf *pixbuf{ nullptr };
+                    if (header == nullptr)
+                    {
+                        return pixbuf;
+                    }
+
+                    if (header->encoding == Encoding::Qoi)
+                    {
+                        pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, header->alpha, 8,
+                                                header->width, header->height);
+                        if (pixbuf != nullptr &&
+                            !qoi::decode(resource.buffer.data, resource.buffer.size,
+                                         gdk_pixbuf_get_pixels(pixbuf), header->width,
+                                         header->height, gdk_pixbuf_get_rowstride(pixbuf),
+                                         gdk_pixbuf_get_n_channels(pixbuf)))
+                        {
+                            g_object_unref(pixbuf);
+                            pixbuf = nullptr;
+                        }
+
+                        qoi_duration.observe((g_get_monotonic_time() - started_at) / 1000000.0);
+                    }
+                    else if (header->encoding == Encoding::Raw)
+                    {
+                        /* The pixels stay where the cache put them, usually the pack store's */
+                        /* mapping, and the pixbuf keeps them alive through the GBytes       */
+                        /* wrapping                                                          */
+                        auto storage = new std::shared_ptr<const void>{ resource.storage };
+                        auto bytes = g_bytes_new_with_free_func(
+                            resource.buffer.data, resource.buffer.size,
+                            [](void *data) {
+                                delete static_cast<std::shared_ptr<const void> *>(data);
+                            },
+                            storage);
+
+                        pixbuf = gdk_pixbuf_new_from_bytes(
+                            bytes, GDK_COLORSPACE_RGB, header->alpha, header->bits_per_sample,
+                            header->width, header->height, header->rowstride);
+                        g_bytes_unref(bytes);
+
+                        raw_duration.observe((g_get_monotonic_time() - started_at) / 1000000.0);
+                    }
+
+                    return pixbuf;
+                }
+
+                /* The artwork with the given content at width x height, from memory or made */
+                /* from the smallest cached level that covers it. nullptr if there is none.  */
+                inline GdkPixbuf *load_content(cache_t &rc,
+                                               string_view cache_prefix,
+                                               std::uint64_t content_hash,
+                                               int width,
+                                               int height) noexcept
+                {
+                    const auto key =
+                        pixbuf_cache_key(cache_prefix, content_id(content_hash), width, height);
+
+                    GdkPixbuf *pixbuf{ pixbuf_cache::lookup(key) };
+                    if (pixbuf != nullptr)
+                    {
+                        return pixbuf;
+                    }
+
+                    GdkPixbuf *level_pixbuf{ nullptr };
+                    for (auto level = level_for(width, height);
+                         level_pixbuf == nullptr && level <= LEVELS.back(); level *= 2)
+                    {
+                        auto result = rc.from_cache(cache_prefix, level_id(content_hash, level));
+                        level_pixbuf = pixbuf_from_cache(result.first);
+                    }
+
+                    if (level_pixbuf == nullptr)
+                    {
+                        return pixbuf;
+                    }
+
+                    pixbuf = resample(level_pixbuf, width, height);
+                    g_object_unref(level_pixbuf);
+
+                    if (pixbuf != nullptr)
+                    {
+                        pixbuf_cache::insert(key, pixbuf);
+                    }
+
+                    return pixbuf;
+                }
+
+                inline void cache_level(cache_t &rc,
+                                        string_view cache_prefix,
+                                        std::uint64_t content_hash,
+                                        int level,
+                                        GdkPixbuf *pixbuf) noexcept
+                {
+                    cache_t::Resource resource;
+
+                    auto header = new_header(resource);
+                    header->alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+                    header->bits_per_sample = gdk_pixbuf_get_bits_per_sample(pixbuf);
+                    header->width = gdk_pixbuf_get_width(pixbuf);
+                    header->height = gdk_pixbuf_get_height(pixbuf);
+                    header->rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+                    header->encoding = Encoding::Raw;
+                    header->content_hash = content_hash;
+                    guint size{ 0 };
+                    resource.buffer.data = gdk_pixbuf_get_pixels_with_length(pixbuf, &size);
+                    resource.buffer.size = size;
+
+                    std::vector<std::uint8_t> compressed{};
+                    if (settings::compress_artwork_cache() && header->bits_per_sample == 8)
+                    {
+                        compressed = qoi::encode(resource.buffer.data, header->width,
+                                                 header->height, header->rowstride,
+                                                 gdk_pixbuf_get_n_channels(pixbuf));
+                    }
+                    if (!compressed.empty() && compressed.size() < resource.buffer.size)
+                    {
+                        header->encoding = Encoding::Qoi;
+                        resource.buffer.data = compressed.data();
+                        resource.buffer.size = compressed.size();
+                    }
+
+                    rc.to_cache(cache_prefix, level_id(content_hash, level), resource);
+                }
+
+                /* Caches `pixbuf` as `level` and every level below it, each one scaled down */
+                /* from the previous                                                        */
+                inline void cache_levels(cache_t &rc,
+                                         string_view cache_prefix,
+                                         std::uint64_t content_hash,
+                                         int level,
+                                         GdkPixbuf *pixbuf) noexcept
+                {
+                    TRACE_SPAN("pixbuf", "Build levels");
+
+                    auto level_pixbuf = GDK_PIXBUF(g_object_ref(pixbuf));
+                    for (;;)
+                    {
+                        cache_level(rc, cache_prefix, content_hash, level, level_pixbuf);
+                        if (level <= LEVELS.front())
+                        {
+                            break;
+                        }
+
+                        level /= 2;
+                        auto smaller =
+                            gdk_pixbuf_scale_simple(level_pixbuf, level, level, GDK_INTERP_HYPER);
+                        g_object_unref(level_pixbuf);
+                        level_pixbuf = smaller;
+                        if (level_pixbuf == nullptr)
+                        {
+                            return;
+                        }
+                    }
+                    g_object_unref(level_pixbuf);
+                }
+
+                /* The palette of the artwork with the given content, as it was cached the */
+                /* first time the artwork was decoded                                        */
+                inline std::pair<palette_t, bool> cached_palette(
+                    cache_t &rc, string_view cache_prefix, std::uint64_t content_hash) noexcept
+                {
+                    auto result = rc.from_cache(cache_prefix, content_id(content_hash));
+                    auto header = header_of(result.first);
+                    if (header == nullptr || header->encoding != Encoding::Palette)
+                    {
+                        return { palette_t{}, false };
+                    }
+
+                    return { header->palette, true };
+                }
+
+                inline void cache_palette(cache_t &rc,
+                                          string_view cache_prefix,
+                                          std::uint64_t content_hash,
+                                          const palette_t &palette) noexcept
+                {
+                    cache_t::Resource resource;
+
+                    auto header = new_header(resource);
+                    header->encoding = Encoding::Palette;
+                    header->content_hash = content_hash;
+                    header->palette = palette;
+
+                    /* Resources need some data to count as cached, the id is as good as any */
+                    const auto id = content_id(content_hash);
+                    resource.buffer.data = reinterpret_cast<const std::uint8_t *>(id.data());
+                    resource.buffer.size = id.size();
+
+                    rc.to_cache(cache_prefix, id, resource);
+                }
+
+                /* Reads the palette of the artwork with the given content from the cache, or */
+                /* extracts it from `pixbuf` and caches it if this is the first time around  */
+                inline palette_t artwork_palette(cache_t &rc,
+                                                 string_view cache_prefix,
+                                                 std::uint64_t content_hash,
+                                                 GdkPixbuf *pixbuf) noexcept
+                {
+                    auto cached = cached_palette(rc, cache_prefix, content_hash);
+                    if (cached.second)
+                    {
+                        return cached.first;
+                    }
+
+                    palette_t palette{};
+                    if (gdk_pixbuf_get_bits_per_sample(pixbuf) == 8)
+                    {
+                        palette = extract_palette(
+                            gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_width(pixbuf),
+                            gdk_pixbuf_get_height(pixbuf), gdk_pixbuf_get_rowstride(pixbuf),
+                            gdk_pixbuf_get_n_channels(pixbuf));
+                    }
+                    cache_palette(rc, cache_prefix, content_hash, palette);
+
+                    return palette;
+                }
+
+                inline void cache_reference(cache_t &rc,
+                                            string_view cache_prefix,
+                                            string_view resource_id,
+                                            std::uint64_t content_hash) noexcept
+                {
+                    cache_t::Resource resource;
+
+                    auto header = new_header(resource);
+                    header->encoding = Encoding::Reference;
+                    header->content_hash = content_hash;
+
+                    /* Resources need some data to count as cached, the id is as good as any */
+                    const auto id = content_id(content_hash);
+                    resource.buffer.data = reinterpret_cast<const std::uint8_t *>(id.data());
+                    resource.buffer.size = id.size();
+
+                    rc.to_cache(cache_prefix, resource_id, resource);
+                }
+
+                /* Caches artwork downloaded at `level` for resource_id, storing the levels */
+                /* only if no identical artwork is cached yet. Returns a new reference to   */
+                /* the artwork at width x height, or nullptr if it can't be decoded.        */
+                inline GdkPixbuf *cache_download(cache_t &rc,
+                                                 string_view cache_prefix,
+                                                 string_view resource_id,
+                                                 const std::string &data,
+                                                 int level,
+                                                 int width,
+                                                 int height) noexcept
+                {
+                    static auto &deduplicated = metrics::counter(
+                        "spring_artwork_deduplicated_total",
+                        "Downloaded artwork that was already cached for another resource");
+
+                    const auto hash = content_hash(data.data(), data.size());
+                    const auto key =
+                        pixbuf_cache_key(cache_prefix, content_id(hash), width, height);
+
+                    auto pixbuf = load_content(rc, cache_prefix, hash, width, height);
+                    if (pixbuf != nullptr)
+                    {
+                        deduplicated.increment();
+                    }
+                    else
+                    {
+                        auto level_pixbuf = load_pixbuf_from_data_scaled(data, level, level);
+                        if (level_pixbuf == nullptr)
+                        {
+                            return level_pixbuf;
+                        }
+
+                        cache_levels(rc, cache_prefix, hash, level, level_pixbuf);
+
+                        pixbuf = resample(level_pixbuf, width, height);
+                        g_object_unref(level_pixbuf);
+                        if (pixbuf == nullptr)
+                        {
+                            return pixbuf;
+                        }
+
+                        pixbuf_cache::insert(key, pixbuf);
+                    }
+
+                    cache_reference(rc, cache_prefix, resource_id, hash);
+                    pixbuf_cache::alias(pixbuf_cache_key(cache_prefix, resource_id, width, height),
+                                        key);
+
+                    return pixbuf;
+                }
+            } // namespace artwork
+
+            /* The artwork of content_provider if it's already decoded and in memory, cheap    */
+            /* enough to call from the main thread. Returns a new reference or nullptr.       */
+            template <int width, int height, typename ContentProvider>
+            GdkPixbuf *cached_artwork(string_view cache_prefix,
+                                      const ContentProvider &content_provider,
+                                      int scale_factor = 1) noexcept
+            {
+                return pixbuf_cache::lookup(
+                    artwork::pixbuf_cache_key(cache_prefix, content_provider.id(),
+                                              width * scale_factor, height * scale_factor));
+            }
+
+            /* Loads the artwork of content_provider for a width x height view, in device pixels */
+            /* for the given scale factor. The image is requested from the server already       */
+            /* resized to the nearest artwork::LEVELS entry and kept in the ResourceCache under */
+            /* cache_prefix at that level and every one below it, QOI compressed unless that's  */
+            /* turned off in the settings. Artwork is deduplicated by the hash of the download: */
+            /* it's stored and decoded once, and shared through the pixbuf_cache, no matter how */
+            /* many resources it belongs to. Returns a new reference, or nullptr if no artwork  */
+            /* could be loaded.                                                                 */
+            template <int width, int height, typename ContentProvider>
+            GdkPixbuf *load_artwork(string_view cache_prefix,
+                                    const ContentProvider &content_provider,
+                                    int scale_factor = 1) noexcept
+            {
+                using namespace artwork;
+
+                const auto pixel_width = width * scale_factor;
+                const auto pixel_height = height * scale_factor;
+                const auto key = pixbuf_cache_key(cache_prefix, content_provider.id(),
+                                                  pixel_width, pixel_height);
+
+                GdkPixbuf *pixbuf{ pixbuf_cache::lookup(key) };
+                if (pixbuf != nullptr)
+                {
+                    return pixbuf;
+                }
+
+                cache_t rc;
+
+                auto result = rc.from_cache(cache_prefix, content_provider.id());
+                if (!result.second)
+                {
+                    return pixbuf;
+                }
+
+                auto header = header_of(result.first);
+                if (header != nullptr && header->encoding == Encoding::Reference)
+                {
+                    /* Gone if the content was evicted, or if only smaller levels were cached, */
+                    /* it's downloaded again below                                             */
+                    pixbuf = load_content(rc, cache_prefix, header->content_hash, pixel_width,
+                                          pixel_height);
+                    if (pixbuf != nullptr)
+                    {
+                        pixbuf_cache::alias(key,
+                                            pixbuf_cache_key(cache_prefix,
+                                                             content_id(header->content_hash),
+                                                             pixel_width, pixel_height));
+                        return pixbuf;
+                    }
+                }
+
+                /* Not cached or unusable, load it from the server and cache it */
+                const auto level = level_for(pixel_width, pixel_height);
+                pixbuf = cache_download(rc, cache_prefix, content_provider.id(),
+                                        content_provider.artwork(level, level), level,
+                                        pixel_width, pixel_height);
+                if (pixbuf == nullptr)
+                {
+                    LOG_WARN("ArtworkLoader: Failed to decode artwork for {}",
+                             content_provider.id());
+                }
+
+                return pixbuf;
+            }
+
+            /* Makes sure the artwork of content_provider is in the ResourceCache, at the level */
+            /* a width x height view needs at the given scale factor, without decoding what's   */
+            /* already there. Returns the number of bytes downloaded.                           */
+            template <int width, int height, typename ContentProvider>
+            std::size_t prefetch_artwork(string_view cache_prefix,
+                                         const ContentProvider &content_provider,
+                                         int scale_factor = 1) noexcept
+            {
+                using namespace artwork;
+
+                const auto pixel_width = width * scale_factor;
+                const auto pixel_height = height * scale_factor;
+
+                cache_t rc;
+                const auto level = level_for(pixel_width, pixel_height);
+
+                auto result = rc.from_cache(cache_prefix, content_provider.id());
+                if (!result.second)
+                {
+                    return 0;
+                }
+
+                auto header = header_of(result.first);
+                if (header != nullptr && header->encoding == Encoding::Reference &&
+                    header_of(
+                        rc.from_cache(cache_prefix, level_id(header->content_hash, level)).first) !=
+                        nullptr)
+                {
+                    return 0;
+                }
+
+                const auto data = content_provider.artwork(level, level);
+                auto pixbuf = cache_download(rc, cache_prefix, content_provider.id(), data, level,
+                                             pixel_width, pixel_height);
+                if (pixbuf != nullptr)
+                {
+                    g_object_unref(pixbuf);
+                }
+
+                return data.size();
+            }
+
+            /* Shows artwork loaded for the given scale factor at its size in logical pixels */
+            inline void set_image_from_artwork(GtkImage *image,
+                                               GdkPixbuf *artwork,
+                                               int scale_factor) noexcept
+            {
+                auto surface = gdk_cairo_surface_create_from_pixbuf(artwork, scale_factor, nullptr);
+                gtk_image_set_from_surface(image, surface);
+                cairo_surface_destroy(surface);
+            }
+        } // namespace utility
+    }     // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_ARTWORK_LOADER_H
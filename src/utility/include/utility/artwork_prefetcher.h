@@ -0,0 +1,85 @@
+#ifndef SPRING_PLAYER_UTILITY_ARTWORK_PREFETCHER_H
+#define SPRING_PLAYER_UTILITY_ARTWORK_PREFETCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libspring_global.h>
+#include <libspring_music_library.h>
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            /* Warms the ResourceCache with the artwork of every album and artist in a library, */
+            /* so pages show it straight away the first time they are visited. Downloads run  */
+            /* one at a time as background requests, are only scheduled when the main loop is */
+            /* idle and are spaced out to stay within settings::artwork_prefetch_rate(). The  */
+            /* last finished item is remembered across restarts. Progress is logged and       */
+            /* published as spring_artwork_prefetch_* metrics.                                */
+            /* Only to be used from the main thread.                                          */
+            class ArtworkPrefetcher
+            {
+            public:
+                struct Progress
+                {
+                    std::size_t completed;
+                    std::size_t total;
+                };
+
+            public:
+                ArtworkPrefetcher() noexcept;
+                ~ArtworkPrefetcher() noexcept;
+
+            public:
+                /* Replaces whatever was being prefetched with the content of `library`, */
+                /* at the size thumbnails need on a display with the given scale factor  */
+                void start(std::shared_ptr<MusicLibrary> library, int scale_factor) noexcept;
+                void stop() noexcept;
+
+                /* Delays the next download by a few seconds. Meant to be called for as long */
+                /* as the network is needed for something more important, e.g. buffering    */
+                /* the track that is playing.                                               */
+                void hold_off() noexcept;
+
+                Progress progress() const noexcept;
+
+            private:
+                struct item_t
+                {
+                    std::string id;
+                    /* Returns the number of bytes downloaded */
+                    std::function<std::size_t()> prefetch;
+                };
+
+            private:
+                void on_items_listed() noexcept;
+                void on_item_prefetched(std::size_t bytes) noexcept;
+                void schedule_next(std::uint32_t delay_ms) noexcept;
+                void prefetch_next() noexcept;
+
+            private:
+                std::vector<item_t> items_{};
+                std::size_t next_{ 0 };
+                std::uint64_t rate_{ 0 };
+                std::uint32_t source_id_{ 0 };
+                /* In g_get_monotonic_time() microseconds */
+                std::int64_t held_off_until_{ 0 };
+
+                /* Replaced on every start(), which orphans the requests of the previous run */
+                std::shared_ptr<void> lifeline_{};
+
+            private:
+                DISABLE_COPY(ArtworkPrefetcher)
+                DISABLE_MOVE(ArtworkPrefetcher)
+            };
+        } // namespace utility
+    }     // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_ARTWORK_PREFETCHER_H
@@ -1,9 +1,14 @@
 #ifndef SPRING_PLAYER_ASYNC_QUEUE_H
 #define SPRING_PLAYER_ASYNC_QUEUE_H
 
-#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 
+#include "forward_declarations.h"
+#include "inline_task.h"
+
 namespace spring
 {
     namespace player
@@ -12,19 +17,86 @@ namespace spring
         {
             namespace async_queue
             {
+                class CancellationToken
+                {
+                public:
+                    static CancellationToken create() noexcept
+                    {
+                        CancellationToken result;
+                        result.cancelled_ = std::make_shared<std::atomic_bool>(false);
+                        return result;
+                    }
+
+                public:
+                    inline void cancel() const noexcept
+                    {
+                        if (cancelled_ != nullptr)
+                        {
+                            *cancelled_ = true;
+                        }
+                    }
+
+                    inline bool cancelled() const noexcept
+                    {
+                        return cancelled_ != nullptr && *cancelled_;
+                    }
+
+                    inline explicit operator bool() const noexcept { return cancelled_ != nullptr; }
+
+                private:
+                    std::shared_ptr<std::atomic_bool> cancelled_{};
+                };
+
+                /* Big enough for the captures of all the requests and responses posted by  */
+                /* the UI, so queuing them doesn't allocate; anything larger goes on the heap */
+                using Task = InlineTask<96>;
+
                 struct Request
                 {
                     const char *id;
-                    std::function<void()> request;
+                    Task request;
+                    /* A pending request with the same key is cancelled when this one is queued */
+                    const char *supersedes{ nullptr };
+                    /* Cancelled requests are dropped before they run */
+                    CancellationToken token{};
+                    /* Set when the request is queued, used for the queue's telemetry */
+                    std::int64_t queued_at{ 0 };
+                    /* Links the span that queued the request to the one running it */
+                    std::uint64_t trace_flow{ 0 };
                 };
 
+                /* A response posted without a token inherits the token of the request that */
+                /* posted it, and is dropped if that request gets cancelled in the meantime */
                 using Response = Request;
 
+                /* Workers always pick up the most urgent request available, from their own */
+                /* queue first and then by stealing from the other workers                    */
+                enum class Priority
+                {
+                    Interactive, /* The user is waiting on the result */
+                    Visible,     /* Content that is currently on screen, e.g. artwork */
+                    Background,  /* Prefetching and other speculative work */
+                    Count
+                };
+
                 void start_processing() noexcept;
                 void stop_processing() noexcept;
+                void push_request(Priority priority, Request &&request) noexcept;
+                /* Equivalent to push_request(Priority::Visible, ...) */
                 void push_back_request(Request &&request) noexcept;
+                /* Equivalent to push_request(Priority::Interactive, ...) */
                 void push_front_request(Request &&request) noexcept;
                 void post_response(Response &&response) noexcept;
+
+                /* Responses are run on the main thread in batches, once per frame of the  */
+                /* widget's frame clock and within a fixed time budget, with what doesn't */
+                /* fit carried over to the next frame. Until this is called, or while the */
+                /* widget isn't realized, they are drained from an idle callback instead. */
+                void drain_responses_on_frame_clock(GtkWidget *widget) noexcept;
+
+                /* Lets a running request check, at points where it is safe to bail out, */
+                /* whether it was cancelled or superseded since it started               */
+                bool cancelled() noexcept;
             } // namespace async_queue
         }     // namespace utility
     }         // namespace player
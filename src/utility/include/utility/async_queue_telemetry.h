@@ -0,0 +1,97 @@
+#ifndef SPRING_PLAYER_ASYNC_QUEUE_TELEMETRY_H
+#define SPRING_PLAYER_ASYNC_QUEUE_TELEMETRY_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "async_queue.h"
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            namespace async_queue
+            {
+                namespace telemetry
+                {
+                    /* Bucket i counts durations below 100us << i, the last one everything longer */
+                    struct histogram_t
+                    {
+                        static constexpr std::size_t BUCKET_COUNT{ 16 };
+
+                        static constexpr std::int64_t upper_bound(std::size_t bucket) noexcept
+                        {
+                            return bucket + 1 < BUCKET_COUNT ? std::int64_t{ 100 } << bucket
+                                                             : INT64_MAX;
+                        }
+
+                        /* Upper bound of the bucket the given percentile (0-100) falls in */
+                        std::int64_t percentile(std::uint32_t p) const noexcept;
+
+                        std::array<std::uint64_t, BUCKET_COUNT> buckets{};
+                    };
+
+                    struct timing_t
+                    {
+                        std::uint64_t count{ 0 };
+                        std::int64_t total_us{ 0 };
+                        std::int64_t max_us{ 0 };
+                        histogram_t histogram{};
+                    };
+
+                    struct request_stats_t
+                    {
+                        std::string id;
+                        /* Requests dropped because they were cancelled or superseded */
+                        std::uint64_t dropped{ 0 };
+                        /* Time spent queued, from push_request until a worker picked it up */
+                        timing_t wait{};
+                        /* Time spent running on the worker */
+                        timing_t run{};
+                    };
+
+                    struct depth_t
+                    {
+                        std::size_t current{ 0 };
+                        std::size_t peak{ 0 };
+                    };
+
+                    struct queue_depth_t
+                    {
+                        std::array<depth_t, static_cast<std::size_t>(Priority::Count)> requests{};
+                        /* Responses waiting to be run on the main thread */
+                        depth_t responses{};
+                    };
+
+                    /* Stats for every request id seen so far; for responses `wait` is the time */
+                    /* between post_response and the callback running on the main thread      */
+                    std::vector<request_stats_t> request_stats() noexcept;
+                    std::vector<request_stats_t> response_stats() noexcept;
+                    queue_depth_t queue_depth() noexcept;
+
+                    void log_summary() noexcept;
+                    /* Logs a summary every `interval_seconds`, 0 turns it off. Also enabled by */
+                    /* setting SPRING_PLAYER_QUEUE_STATS to an interval when the queue starts */
+                    void set_summary_interval(std::uint32_t interval_seconds) noexcept;
+
+                    /* Called by async_queue itself */
+                    std::int64_t now() noexcept;
+                    void request_queued(Priority priority) noexcept;
+                    void request_dequeued(Priority priority) noexcept;
+                    void request_dropped(const char *id) noexcept;
+                    void request_finished(const char *id, std::int64_t queued_at,
+                                          std::int64_t started_at) noexcept;
+                    void response_queued() noexcept;
+                    void response_dequeued(const char *id, std::int64_t queued_at,
+                                           bool dropped) noexcept;
+                } // namespace telemetry
+            }     // namespace async_queue
+        }         // namespace utility
+    }             // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_ASYNC_QUEUE_TELEMETRY_H
@@ -0,0 +1,45 @@
+#ifndef SPRING_PLAYER_UTILITY_COLOR_PALETTE_H
+#define SPRING_PLAYER_UTILITY_COLOR_PALETTE_H
+
+#include <array>
+#include <cstdint>
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            struct color_t
+            {
+                std::uint8_t red;
+                std::uint8_t green;
+                std::uint8_t blue;
+            };
+
+            constexpr std::size_t PALETTE_SIZE{ 5 };
+
+            /* Plain data, so it can be stored as is in a ResourceCache header */
+            struct palette_t
+            {
+                /* Zero if the image had no usable colors */
+                std::uint8_t size;
+                /* Most common first, colors[0] being the dominant one */
+                std::array<color_t, PALETTE_SIZE> colors;
+            };
+
+            /* The most common colors of 8 bit RGB or RGBA pixels, counted in a fixed size    */
+            /* histogram of 16 levels per channel without allocating. Near white and near     */
+            /* black pixels are left out, as they are usually background or shadows. Colors   */
+            /* in neighbouring histogram cells are merged into the more common one, so the    */
+            /* palette doesn't end up with shades of the same color.                          */
+            palette_t extract_palette(const std::uint8_t *pixels,
+                                      std::int32_t width,
+                                      std::int32_t height,
+                                      std::int32_t rowstride,
+                                      std::int32_t channel_count) noexcept;
+        } // namespace utility
+    }     // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_COLOR_PALETTE_H
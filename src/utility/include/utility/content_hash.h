@@ -0,0 +1,20 @@
+#ifndef SPRING_PLAYER_UTILITY_CONTENT_HASH_H
+#define SPRING_PLAYER_UTILITY_CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            /* XXH64 (https://github.com/Cyan4973/xxHash) of `data`, fast enough to run over */
+            /* every downloaded image and good enough to tell them apart by content alone  */
+            std::uint64_t content_hash(const void *data, std::size_t size) noexcept;
+        } // namespace utility
+    }     // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_CONTENT_HASH_H
@@ -6,6 +6,7 @@
 
 #include "forward_declarations.h"
 #include "g_object_guard.h"
+#include "main_loop_watchdog.h"
 
 #define get_widget_from_builder_simple(widget_name)                                                \
     widget_name##_ = utility::gtk_cast<std::remove_pointer<decltype(widget_name##_)>::type>(       \
@@ -67,10 +68,9 @@ namespace spring
                                          SignalHandlerType signal_handler,
                                          UserDataType *user_data) noexcept
             {
-                return g_signal_connect_data(static_cast<void *>(instance), signal,
-                                             reinterpret_cast<void (*)()>(signal_handler),
-                                             static_cast<void *>(user_data), nullptr,
-                                             static_cast<GConnectFlags>(0));
+                return main_loop_watchdog::connect_signal(
+                    static_cast<void *>(instance), signal,
+                    reinterpret_cast<void (*)()>(signal_handler), static_cast<void *>(user_data));
             }
 
             template <typename GObjectType, typename SignalHandlerType, typename UserDataType>
@@ -79,10 +79,9 @@ namespace spring
                                          SignalHandlerType signal_handler,
                                          UserDataType *user_data) noexcept
             {
-                return g_signal_connect_data(static_cast<void *>(instance), signal,
-                                             reinterpret_cast<void (*)()>(signal_handler),
-                                             static_cast<void *>(user_data), nullptr,
-                                             static_cast<GConnectFlags>(0));
+                return main_loop_watchdog::connect_signal(
+                    static_cast<void *>(instance), signal,
+                    reinterpret_cast<void (*)()>(signal_handler), static_cast<void *>(user_data));
             }
         } // namespace utility
     }     // namespace player
@@ -0,0 +1,184 @@
+#ifndef SPRING_PLAYER_UTILITY_INLINE_TASK_H
+#define SPRING_PLAYER_UTILITY_INLINE_TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            /* Move-only replacement for std::function<void()>. Callables that fit in        */
+            /* `capacity` bytes are stored inline, so queuing them doesn't touch the heap;   */
+            /* larger ones (or ones that can throw while being moved) fall back to new/delete */
+            template <std::size_t capacity> class InlineTask
+            {
+            public:
+                inline InlineTask() noexcept = default;
+                inline InlineTask(std::nullptr_t) noexcept {}
+
+                template <typename F,
+                          typename Callable = typename std::decay<F>::type,
+                          typename = typename std::enable_if<
+                              !std::is_same<Callable, InlineTask>::value>::type>
+                inline InlineTask(F &&f) noexcept
+                {
+                    construct<Callable>(std::forward<F>(f),
+                                        std::integral_constant<bool, stored_inline<Callable>()>{});
+                }
+
+                inline InlineTask(InlineTask &&other) noexcept { take(other); }
+
+                inline InlineTask &operator=(InlineTask &&other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        reset();
+                        take(other);
+                    }
+
+                    return *this;
+                }
+
+                inline InlineTask &operator=(std::nullptr_t) noexcept
+                {
+                    reset();
+                    return *this;
+                }
+
+                InlineTask(const InlineTask &) = delete;
+                InlineTask &operator=(const InlineTask &) = delete;
+
+                inline ~InlineTask() noexcept { reset(); }
+
+            public:
+                inline void operator()() { operations_->invoke(&storage_); }
+
+                inline explicit operator bool() const noexcept { return operations_ != nullptr; }
+                inline bool operator==(std::nullptr_t) const noexcept
+                {
+                    return operations_ == nullptr;
+                }
+                inline bool operator!=(std::nullptr_t) const noexcept
+                {
+                    return operations_ != nullptr;
+                }
+
+            private:
+                struct operations_t
+                {
+                    void (*invoke)(void *storage);
+                    /* Move-constructs into `destination` and destroys what's left in `source` */
+                    void (*relocate)(void *destination, void *source) noexcept;
+                    void (*destroy)(void *storage) noexcept;
+                };
+
+                static_assert(capacity >= sizeof(void *), "InlineTask can't fit a pointer");
+
+                template <typename Callable> static constexpr bool stored_inline() noexcept
+                {
+                    return sizeof(Callable) <= capacity &&
+                           alignof(Callable) <= alignof(std::max_align_t) &&
+                           std::is_nothrow_move_constructible<Callable>::value;
+                }
+
+                template <typename Callable, typename F>
+                inline void construct(F &&f, std::true_type /* inline */) noexcept
+                {
+                    new (&storage_) Callable(std::forward<F>(f));
+                    operations_ = &inline_operations<Callable>;
+                }
+
+                template <typename Callable, typename F>
+                inline void construct(F &&f, std::false_type /* inline */) noexcept
+                {
+                    *reinterpret_cast<Callable **>(&storage_) = new Callable(std::forward<F>(f));
+                    operations_ = &heap_operations<Callable>;
+                }
+
+                template <typename Callable> static void invoke_inline(void *storage)
+                {
+                    (*static_cast<Callable *>(storage))();
+                }
+
+                template <typename Callable>
+                static void relocate_inline(void *destination, void *source) noexcept
+                {
+                    auto callable = static_cast<Callable *>(source);
+                    new (destination) Callable(std::move(*callable));
+                    callable->~Callable();
+                }
+
+                template <typename Callable> static void destroy_inline(void *storage) noexcept
+                {
+                    static_cast<Callable *>(storage)->~Callable();
+                }
+
+                template <typename Callable> static void invoke_heap(void *storage)
+                {
+                    (**static_cast<Callable **>(storage))();
+                }
+
+                static void relocate_heap(void *destination, void *source) noexcept
+                {
+                    *static_cast<void **>(destination) = *static_cast<void **>(source);
+                }
+
+                template <typename Callable> static void destroy_heap(void *storage) noexcept
+                {
+                    delete *static_cast<Callable **>(storage);
+                }
+
+                template <typename Callable>
+                static constexpr operations_t inline_operations{ &invoke_inline<Callable>,
+                                                                 &relocate_inline<Callable>,
+                                                                 &destroy_inline<Callable> };
+
+                template <typename Callable>
+                static constexpr operations_t heap_operations{ &invoke_heap<Callable>,
+                                                               &relocate_heap,
+                                                               &destroy_heap<Callable> };
+
+                inline void take(InlineTask &other) noexcept
+                {
+                    if (other.operations_ != nullptr)
+                    {
+                        other.operations_->relocate(&storage_, &other.storage_);
+                        operations_ = other.operations_;
+                        other.operations_ = nullptr;
+                    }
+                }
+
+                inline void reset() noexcept
+                {
+                    if (operations_ != nullptr)
+                    {
+                        operations_->destroy(&storage_);
+                        operations_ = nullptr;
+                    }
+                }
+
+            private:
+                typename std::aligned_storage<capacity, alignof(std::max_align_t)>::type
+                    storage_;
+                const operations_t *operations_{ nullptr };
+            };
+
+            template <std::size_t capacity>
+            template <typename Callable>
+            constexpr typename InlineTask<capacity>::operations_t
+                InlineTask<capacity>::inline_operations;
+
+            template <std::size_t capacity>
+            template <typename Callable>
+            constexpr typename InlineTask<capacity>::operations_t
+                InlineTask<capacity>::heap_operations;
+        } // namespace utility
+    }     // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_INLINE_TASK_H
@@ -0,0 +1,53 @@
+#ifndef SPRING_PLAYER_UTILITY_MAIN_LOOP_WATCHDOG_H
+#define SPRING_PLAYER_UTILITY_MAIN_LOOP_WATCHDOG_H
+
+#include <cstdint>
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            namespace main_loop_watchdog
+            {
+                /* Times every iteration of the default main context, from the moment poll()   */
+                /* returns until it's entered again, i.e. all the work done in between waits.  */
+                /* Iterations over `budget_ms` are logged, traced and counted in the metrics   */
+                /* registry under the longest Activity that ran during them.                   */
+                void start(std::uint32_t budget_ms = 16) noexcept;
+                void stop() noexcept;
+
+                /* Same as g_signal_connect(), except that every emission handled on the main */
+                /* thread counts as an Activity named after the instance's type and the      */
+                /* signal, e.g. "GtkButton::clicked". Covers the work GTK dispatches to us    */
+                /* that no Activity was opened for.                                           */
+                std::uint64_t connect_signal(void *instance,
+                                             const char *signal,
+                                             void (*handler)(),
+                                             void *user_data) noexcept;
+
+                /* Names the main-thread work done for the rest of the enclosing scope, for    */
+                /* attributing stalls. `name` has to outlive the iteration, string literals    */
+                /* and request ids are the norm. Does nothing when used off the main thread or */
+                /* while the watchdog isn't running.                                          */
+                class Activity
+                {
+                public:
+                    explicit Activity(const char *name) noexcept;
+                    ~Activity() noexcept;
+
+                private:
+                    Activity(const Activity &) = delete;
+                    Activity &operator=(const Activity &) = delete;
+
+                private:
+                    const char *name_;
+                    std::int64_t started_at_{ -1 };
+                };
+            } // namespace main_loop_watchdog
+        }     // namespace utility
+    }         // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_MAIN_LOOP_WATCHDOG_H
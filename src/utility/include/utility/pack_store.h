@@ -0,0 +1,138 @@
+#ifndef SPRING_PLAYER_UTILITY_PACK_STORE_H
+#define SPRING_PLAYER_UTILITY_PACK_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <sys/uio.h>
+
+#include <libspring_global.h>
+#include <libspring_metrics.h>
+
+#include "utility/compatibility.h"
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            /* Append-only storage for cached resources. Records are appended to a handful of */
+            /* large segment files, each of them mapped into memory once, and an index file    */
+            /* maps ids to where their latest record lives. Reading a record never copies it.  */
+            /*                                                                                 */
+            /* All stores share the byte budget from settings::cache_size_limit(). Once it's   */
+            /* exceeded the least recently written segment is swept in the background, CLOCK   */
+            /* style: records read since they were written get a second chance and are copied */
+            /* forward, the others are evicted, and the segment file is deleted.              */
+            class PackStore
+            {
+            public:
+                struct Record
+                {
+                    const std::uint8_t *data{ nullptr };
+                    std::size_t size{ 0 };
+                    /* Keeps the mapping `data` points into alive */
+                    std::shared_ptr<const void> storage{};
+
+                    operator bool() const noexcept { return data != nullptr; }
+                };
+
+            public:
+                /* One store per cache prefix, opened on first use and kept around for the */
+                /* rest of the process                                                     */
+                static PackStore &open(const utility::string_view &prefix) noexcept;
+
+                /* Evicts until all stores fit in the budget, normally scheduled by put() */
+                static void enforce_size_limit() noexcept;
+                /* Writes the access times of every open store out to its index */
+                static void sync() noexcept;
+
+            public:
+                /* Appends a record made of `parts` laid out back to back, replacing any */
+                /* previous record with the same id                                      */
+                bool put(const utility::string_view &id,
+                         const iovec *parts,
+                         std::size_t part_count) noexcept;
+
+                /* The second member is false if the store is unusable, a missing record */
+                /* is not an error                                                       */
+                std::pair<Record, bool> get(const utility::string_view &id) const noexcept;
+
+            private:
+                struct Segment;
+
+                struct location_t
+                {
+                    std::uint32_t segment;
+                    std::uint64_t offset;
+                    std::uint64_t size;
+
+                    bool operator==(const location_t &other) const noexcept
+                    {
+                        return segment == other.segment && offset == other.offset &&
+                               size == other.size;
+                    }
+                };
+
+                struct entry_t
+                {
+                    location_t location;
+                    /* Seconds since the epoch, set by get() and cleared whenever the record */
+                    /* is written, so it doubles as the CLOCK reference bit                  */
+                    mutable std::atomic<std::uint32_t> accessed_at;
+                };
+
+            private:
+                PackStore(std::string prefix, std::string directory) noexcept;
+
+                /* When `replaces` is set the record is only indexed if the id still points */
+                /* there, i.e. nobody stored a newer version while it was being copied       */
+                bool append(const utility::string_view &id,
+                            const iovec *parts,
+                            std::size_t part_count,
+                            const location_t *replaces) noexcept;
+
+                /* The least recently written segment, false if there is nothing to sweep */
+                bool oldest_segment(std::uint32_t &number, std::int64_t &written_at) const
+                    noexcept;
+                void sweep_segment(std::uint32_t number) noexcept;
+
+                bool load_index() noexcept;
+                bool append_to_index(const utility::string_view &id,
+                                     const location_t &location) noexcept;
+                /* Replaces the index with one holding only the live entries */
+                bool rewrite_index() noexcept;
+                std::shared_ptr<Segment> open_segment(std::uint32_t number, bool create) noexcept;
+
+            private:
+                const std::string prefix_;
+                const std::string directory_;
+                bool valid_{ false };
+
+                /* shared_mutex would do, but it's C++17 and this still builds as C++14 */
+                mutable std::shared_timed_mutex mutex_{};
+                std::int32_t index_fd_{ -1 };
+                /* By segment number, records are appended to the last one */
+                std::map<std::uint32_t, std::shared_ptr<Segment>> segments_{};
+                std::unordered_map<std::string, entry_t> index_{};
+
+                metrics::Gauge &size_;
+                metrics::Counter &evictions_;
+                metrics::Counter &copied_bytes_;
+
+            private:
+                DISABLE_COPY(PackStore)
+                DISABLE_MOVE(PackStore)
+            };
+        } // namespace utility
+    }     // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_PACK_STORE_H
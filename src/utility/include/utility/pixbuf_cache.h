@@ -0,0 +1,34 @@
+#ifndef SPRING_PLAYER_UTILITY_PIXBUF_CACHE_H
+#define SPRING_PLAYER_UTILITY_PIXBUF_CACHE_H
+
+#include <string>
+
+#include <gdk/gdk.h>
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            /* Process-wide, least recently used set of decoded pixbufs that sits in front of */
+            /* the ResourceCache, so the same artwork shown in several places is decoded only */
+            /* once. Shown artwork is held a second time, as the surface of its GtkImage, so  */
+            /* the capacity only bounds the cache's own copies.                               */
+            /* Safe to use from any thread.                                                   */
+            namespace pixbuf_cache
+            {
+                /* Returns a new reference, or nullptr if `key` isn't cached */
+                GdkPixbuf *lookup(const std::string &key) noexcept;
+                /* Adds a reference of its own, replacing anything cached under `key` */
+                void insert(const std::string &key, GdkPixbuf *pixbuf) noexcept;
+                /* Makes lookups of `alias` return whatever is cached under `key`, for as long */
+                /* as it is cached. Used to share one pixbuf between everything with the same */
+                /* content.                                                                    */
+                void alias(const std::string &alias, const std::string &key) noexcept;
+            } // namespace pixbuf_cache
+        }     // namespace utility
+    }         // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_PIXBUF_CACHE_H
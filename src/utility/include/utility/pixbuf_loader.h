@@ -1,41 +1,100 @@
 #ifndef SPRING_PLAYER_UTILITY_PIXBUF_LOADER_H
 #define SPRING_PLAYER_UTILITY_PIXBUF_LOADER_H
 
+#include <algorithm>
 #include <string>
 
 #include <gdk/gdk.h>
 
+#include <libspring_trace.h>
+
+#include "utility/gtk_helpers.h"
+
 namespace spring
 {
     namespace player
     {
         namespace utility
         {
-            inline GdkPixbuf *load_pixbuf_from_data(const std::string &data) noexcept
+            /* Decodes an image. If a minimum size is given, decoders that can produce a smaller */
+            /* image directly, like JPEG through libjpeg's DCT scaling, are asked for one that  */
+            /* is still twice that size, so large images are never decoded in full just to be  */
+            /* shrunk afterwards. The headroom is left for a better resample by the caller.      */
+            inline GdkPixbuf *load_pixbuf_from_data(const std::string &data,
+                                                    int min_width = 0,
+                                                    int min_height = 0) noexcept
             {
+                TRACE_SPAN("pixbuf", "Decode");
+
+                struct requested_size_t
+                {
+                    int width;
+                    int height;
+                } requested_size{ min_width, min_height };
+
                 auto loader = gdk_pixbuf_loader_new();
 
+                if (min_width > 0 && min_height > 0)
+                {
+                    connect_g_signal(
+                        loader, "size-prepared",
+                        +[](GdkPixbufLoader *loader, gint width, gint height,
+                            requested_size_t *requested) {
+                            const auto scale =
+                                std::max(2.0 * requested->width / width,
+                                         2.0 * requested->height / height);
+                            if (scale < 1.0)
+                            {
+                                gdk_pixbuf_loader_set_size(
+                                    loader, std::max(1, static_cast<int>(width * scale + 0.5)),
+                                    std::max(1, static_cast<int>(height * scale + 0.5)));
+                            }
+                        },
+                        &requested_size);
+                }
+
                 gdk_pixbuf_loader_write(loader, reinterpret_cast<const std::uint8_t *>(data.data()),
                                         data.size(), nullptr);
+                gdk_pixbuf_loader_close(loader, nullptr);
 
+                /* Owned by the loader, which isn't needed anymore */
                 auto pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-
-                gdk_pixbuf_loader_close(loader, nullptr);
+                if (pixbuf != nullptr)
+                {
+                    g_object_ref(pixbuf);
+                }
+                g_object_unref(loader);
 
                 return pixbuf;
             }
 
-            template <int width, int height>
-            inline GdkPixbuf *load_pixbuf_from_data_scaled(const std::string &data) noexcept
+            inline GdkPixbuf *load_pixbuf_from_data_scaled(const std::string &data,
+                                                           int width,
+                                                           int height) noexcept
             {
-                auto pixbuf = load_pixbuf_from_data(data);
+                auto pixbuf = load_pixbuf_from_data(data, width, height);
+                if (pixbuf == nullptr)
+                {
+                    return pixbuf;
+                }
+
+                TRACE_SPAN("pixbuf", "Scale");
+
+                /* The decoded image is at most about twice the target size by now, which */
+                /* keeps the best of gdk-pixbuf's filters cheap                           */
                 auto scaled_pixbuf =
-                    gdk_pixbuf_scale_simple(pixbuf, width, height, GDK_INTERP_TILES);
+                    gdk_pixbuf_scale_simple(pixbuf, width, height, GDK_INTERP_HYPER);
 
                 g_object_unref(pixbuf);
 
                 return scaled_pixbuf;
             }
+
+            template <int width, int height>
+            inline GdkPixbuf *load_pixbuf_from_data_scaled(const std::string &data) noexcept
+            {
+                return load_pixbuf_from_data_scaled(data, width, height);
+            }
         } // namespace utility
     }     // namespace player
 } // namespace spring
@@ -0,0 +1,41 @@
+#ifndef SPRING_PLAYER_UTILITY_QOI_CODEC_H
+#define SPRING_PLAYER_UTILITY_QOI_CODEC_H
+
+#include <cstdint>
+#include <vector>
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            /* Lossless image compression along the lines of QOI (https://qoiformat.org): a    */
+            /* single pass over the pixels emitting runs, references into a small hash table of */
+            /* recently seen colours and small deltas from the previous pixel. It only stores  */
+            /* the pixel stream, the dimensions are expected to be kept alongside it.           */
+            namespace qoi
+            {
+                /* Takes 8 bit RGB (3 channels) or RGBA (4 channels) pixels. Padding at the  */
+                /* end of rows is dropped. Returns an empty vector on invalid parameters.   */
+                std::vector<std::uint8_t> encode(const std::uint8_t *pixels,
+                                                 std::int32_t width,
+                                                 std::int32_t height,
+                                                 std::int32_t rowstride,
+                                                 std::int32_t channel_count) noexcept;
+
+                /* Decodes into `pixels`, which must hold `height` rows of `rowstride` bytes. */
+                /* Returns false if the data is truncated or doesn't match the dimensions.    */
+                bool decode(const std::uint8_t *data,
+                            std::size_t size,
+                            std::uint8_t *pixels,
+                            std::int32_t width,
+                            std::int32_t height,
+                            std::int32_t rowstride,
+                            std::int32_t channel_count) noexcept;
+            } // namespace qoi
+        }     // namespace utility
+    }         // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_QOI_CODEC_H
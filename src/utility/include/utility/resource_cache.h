@@ -7,9 +7,9 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
-#include <sys/stat.h>
-#include <sys/types.h>
+#include <sys/uio.h>
 
 #include <gdk/gdk.h>
 #include <glib-object.h>
@@ -18,10 +18,11 @@
 
 #include <libspring_global.h>
 #include <libspring_logger.h>
+#include <libspring_metrics.h>
 
 #include "utility/compatibility.h"
 #include "utility/forward_declarations.h"
-#include "utility/posix_fd.h"
+#include "utility/pack_store.h"
 #include "utility/settings.h"
 
 namespace spring
@@ -30,16 +31,22 @@ namespace spring
     {
         namespace utility
         {
+            /* Resources are kept in a PackStore per prefix, as their header followed by their */
+            /* data. Resources read back point straight into the store's mapped segments.     */
             template <std::size_t header_length> class ResourceCache
             {
+            public:
                 struct Resource
                 {
                     std::array<std::uint8_t, header_length> header{};
                     struct
                     {
-                        std::uint8_t *data{};
+                        const std::uint8_t *data{};
                         std::size_t size{ 0 };
                     } buffer{};
+                    /* Keeps buffer.data valid for as long as the resource, or a copy of it, */
+                    /* is around. Not needed for resources passed to to_cache.              */
+                    std::shared_ptr<const void> storage{};
 
                     operator bool() const noexcept { return buffer.size > 0; }
                 };
@@ -56,6 +63,23 @@ namespace spring
                 std::pair<Resource, bool> from_cache(
                     const utility::string_view &prefix,
                     const utility::string_view &resource_id) noexcept;
+
+            private:
+                /* Resources cached before the pack store existed were files of their own. Their */
+                /* headers predate any versioning, so they're deleted instead of being moved    */
+                /* into the store.                                                              */
+                static void remove_legacy_file(const utility::string_view &prefix,
+                                               const utility::string_view &resource_id) noexcept;
+
+                struct counters_t
+                {
+                    metrics::Counter &written_bytes;
+                    metrics::Counter &hits;
+                    metrics::Counter &misses;
+                    metrics::Counter &errors;
+                };
+
+                static const counters_t &counters(const utility::string_view &prefix) noexcept;
             };
 
 #include "resource_cache.tpp"
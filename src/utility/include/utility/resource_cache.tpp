@@ -11,54 +11,18 @@ void ResourceCache<header_size>::to_cache(const string_view &prefix,
                                           const string_view &resource_id,
                                           const Resource &resource) noexcept
 {
-    auto path = fmt::format("{}/{}", settings::cache_directory(), prefix);
-    auto full_file_path = fmt::format("{}/{}", path, resource_id);
-    bool created_but_invalid{ false };
+    iovec parts[]{
+        { const_cast<std::uint8_t *>(resource.header.data()), header_size },
+        { const_cast<std::uint8_t *>(resource.buffer.data), resource.buffer.size },
+    };
 
-    auto result = g_mkdir_with_parents(path.c_str(), 0755);
-    if (result > 0)
+    if (PackStore::open(prefix).put(resource_id, parts, 2))
     {
-        auto err = errno;
-        LOG_ERROR("ResourceCache: Failed to create directory {}: {}", path, std::strerror(err));
+        counters(prefix).written_bytes.increment(header_size + resource.buffer.size);
     }
     else
     {
-        posix_fd_t resource_file(full_file_path.c_str(), O_CREAT | O_WRONLY);
-        if (resource_file)
-        {
-            auto bytes_written = write(resource_file(), resource.header.data(), header_size);
-            if (bytes_written < resource.header.size())
-            {
-                LOG_ERROR("ResourceCache: Failed to write file header for {}", full_file_path);
-                created_but_invalid = true;
-            }
-            else
-            {
-                bytes_written = write(resource_file(), resource.buffer.data, resource.buffer.size);
-                if (bytes_written < resource.buffer.size)
-                {
-                    LOG_ERROR("ResourceCache: Failed to write file data for {}", full_file_path);
-                    created_but_invalid = true;
-                }
-            }
-        }
-        else
-        {
-            auto error = errno;
-            LOG_ERROR("ResourceCache: Failed to save file {}: {}", full_file_path,
-                      std::strerror(error));
-        }
-    }
-
-    if (created_but_invalid)
-    {
-        auto result = remove(full_file_path.c_str());
-        if (result < 0)
-        {
-            auto error = errno;
-            LOG_ERROR("ResourceCache: Failed to remove incomplete cached file {}: {}",
-                      full_file_path, std::strerror(error));
-        }
+        LOG_ERROR("ResourceCache: Failed to cache {}/{}", prefix, resource_id);
     }
 }
 
@@ -66,66 +30,89 @@ template <std::size_t header_size>
 std::pair<typename ResourceCache<header_size>::Resource, bool> ResourceCache<
     header_size>::from_cache(const string_view &prefix, const string_view &resource_id) noexcept
 {
-    auto path = fmt::format("{}/{}", settings::cache_directory(), prefix);
-    auto full_file_path = fmt::format("{}/{}", path, resource_id);
-
     Resource result;
-    bool success{ true };
 
-    posix_fd_t resource_file(full_file_path, O_RDONLY);
-    if (!resource_file)
+    auto record = PackStore::open(prefix).get(resource_id);
+    bool success{ record.second };
+
+    if (!success)
+    {
+        LOG_ERROR("ResourceCache: Cache for {} is unavailable", prefix);
+    }
+    else if (!record.first)
+    {
+        remove_legacy_file(prefix, resource_id);
+    }
+    else if (record.first.size < header_size)
     {
-        if (resource_file.error() != ENOENT)
-        {
-            LOG_ERROR("ResourceCache: Failed to open file {}: {}", full_file_path,
-                      std::strerror(resource_file.error()));
-            success = false;
-        }
+        LOG_ERROR("ResourceCache: Corrupt record or bad header size for {}/{}", prefix,
+                  resource_id);
+        success = false;
     }
     else
     {
-        struct stat stbuf;
-        if ((fstat(resource_file(), &stbuf) != 0) || (!S_ISREG(stbuf.st_mode)))
-        {
-            auto error = errno;
-            LOG_ERROR("ResourceCache: Failed to determine file size for {}: {}", full_file_path,
-                      std::strerror(error));
-            success = false;
-        }
-        else
-        {
-            auto file_size{ static_cast<std::size_t>(stbuf.st_size) };
-            if (file_size < header_size)
-            {
-                LOG_ERROR("ResourceCache: Corrupt file or bad header size for {}", full_file_path);
-                success = false;
-            }
-            else
-            {
-                auto bytes_read = read(resource_file(), result.header.data(), header_size);
-                if (bytes_read < header_size)
-                {
-                    auto error = errno;
-                    LOG_ERROR("ResourceCache: Failed to read header for {}: {}", full_file_path,
-                              std::strerror(error));
-                    success = false;
-                }
-                else
-                {
-                    result.buffer.size = file_size - bytes_read;
-                    result.buffer.data = new std::uint8_t[file_size - bytes_read];
-                    bytes_read = read(resource_file(), result.buffer.data, result.buffer.size);
-                    if (bytes_read == -1)
-                    {
-                        auto error = errno;
-                        LOG_ERROR("ResourceCache: Failed to read data for {}: {}", full_file_path,
-                                  std::strerror(error));
-                        success = false;
-                    }
-                }
-            }
-        }
+        std::memcpy(result.header.data(), record.first.data, header_size);
+        result.buffer.data = record.first.data + header_size;
+        result.buffer.size = record.first.size - header_size;
+        result.storage = std::move(record.first.storage);
+    }
+
+    if (success && result)
+    {
+        counters(prefix).hits.increment();
+    }
+    else if (success)
+    {
+        counters(prefix).misses.increment();
+    }
+    else
+    {
+        counters(prefix).errors.increment();
     }
 
     return { result, success };
 }
+
+template <std::size_t header_size>
+void ResourceCache<header_size>::remove_legacy_file(const string_view &prefix,
+                                                    const string_view &resource_id) noexcept
+{
+    const auto path = fmt::format("{}/{}/{}", settings::cache_directory(), prefix, resource_id);
+    if (std::remove(path.c_str()) == 0)
+    {
+        LOG_INFO("ResourceCache: Removed {}, cached before the pack store", path);
+    }
+}
+
+template <std::size_t header_size>
+const typename ResourceCache<header_size>::counters_t &ResourceCache<header_size>::counters(
+    const string_view &prefix) noexcept
+{
+    /* Registering takes the registry's lock and formats the labels, so it's only done once */
+    /* per prefix and thread                                                                 */
+    thread_local std::unordered_map<std::string, counters_t> cache{};
+
+    std::string key{ prefix.data(), prefix.size() };
+    auto it = cache.find(key);
+    if (it == cache.end())
+    {
+        const auto labels = fmt::format("prefix=\"{}\"", prefix);
+        it = cache
+                 .emplace(std::move(key),
+                          counters_t{
+                              metrics::counter("spring_resource_cache_written_bytes_total",
+                                               "Bytes written to the disk cache", labels),
+                              metrics::counter("spring_resource_cache_hits_total",
+                                               "Lookups served from the disk cache", labels),
+                              metrics::counter("spring_resource_cache_misses_total",
+                                               "Lookups for resources not in the disk cache",
+                                               labels),
+                              metrics::counter(
+                                  "spring_resource_cache_errors_total",
+                                  "Lookups that failed on a corrupt or unreadable cache entry",
+                                  labels) })
+                 .first;
+    }
+
+    return it->second;
+}
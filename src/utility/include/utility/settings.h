@@ -1,6 +1,7 @@
 #ifndef SPRING_PLAYER_APPLICATION_SETTINGS_H
 #define SPRING_PLAYER_APPLICATION_SETTINGS_H
 
+#include <cstdint>
 #include <string>
 
 namespace spring
@@ -21,6 +22,14 @@ namespace spring
 
                 void set_current_page(Page page) noexcept;
                 Page get_current_page() noexcept;
+                void set_music_section(const std::string &server, const std::string &key) noexcept;
+                /* Empty if no section was used on `server` yet */
+                std::string get_music_section(const std::string &server) noexcept;
+                /* In bytes */
+                std::uint64_t cache_size_limit() noexcept;
+                bool compress_artwork_cache() noexcept;
+                /* In bytes per second, 0 if prefetching is disabled */
+                std::uint64_t artwork_prefetch_rate() noexcept;
                 const std::string &home_directory() noexcept;
                 const std::string &data_directory() noexcept;
                 const std::string &config_directory() noexcept;
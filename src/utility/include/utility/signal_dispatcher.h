@@ -0,0 +1,27 @@
+#ifndef SPRING_PLAYER_UTILITY_SIGNAL_DISPATCHER_H
+#define SPRING_PLAYER_UTILITY_SIGNAL_DISPATCHER_H
+
+#include "inline_task.h"
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            namespace signal_dispatcher
+            {
+                /* Enough for the signal's lifeline, a pointer to it and a couple of arguments */
+                using Event = InlineTask<64>;
+
+                /* Queues an event to be run on the main thread. Events are kept in a lock-free */
+                /* queue with preallocated, per-thread storage and all of them are drained by a */
+                /* single GSource attached to the main context, which is only woken up when it  */
+                /* goes from having nothing to do to having at least one event pending.         */
+                void post(Event &&event) noexcept;
+            } // namespace signal_dispatcher
+        }     // namespace utility
+    }         // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_UTILITY_SIGNAL_DISPATCHER_H
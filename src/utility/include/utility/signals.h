@@ -2,17 +2,20 @@
 #define SPRING_PLAYER_UTILITY_SIGNALS_H
 
 #include <cstdint>
-#include <functional>
 #include <memory>
+#include <mutex>
+#include <tuple>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "forward_declarations.h"
+#include "main_loop_watchdog.h"
+#include "signal_dispatcher.h"
 
-#define signal(name, ...)                                                                          \
+#define declare_signal(name, delivery, ...)                                                        \
 private:                                                                                           \
-    utility::Signal<__VA_ARGS__> signal_##name##_;                                                 \
+    utility::Signal<__VA_ARGS__> signal_##name##_{ #name, delivery };                              \
     template <typename... Args> inline void emit_##name(Args &&... args) const noexcept            \
     {                                                                                              \
         signal_##name##_.emit(std::forward<Args>(args)...);                                        \
@@ -35,41 +38,51 @@ public:
         signal_##name##_.disconnect(callee);                                                       \
     }
 
+#define signal(name, ...) declare_signal(name, utility::SignalDelivery::Every, __VA_ARGS__)
+
+/* For signals that report a state rather than an event, e.g. how much of a track is cached: */
+/* queued emissions that haven't been delivered yet are replaced by the latest one           */
+#define coalesced_signal(name, ...)                                                                \
+    declare_signal(name, utility::SignalDelivery::Latest, __VA_ARGS__)
+
 namespace spring
 {
     namespace player
     {
         namespace utility
         {
+            enum class SignalDelivery
+            {
+                Every,
+                Latest
+            };
+
             template <typename... Args> class Signal
             {
             public:
                 using signature_t = void (*)(Args..., void *);
 
             private:
-                template <typename Function, typename Tuple, size_t... I>
-                inline static auto call(Function f, Tuple &t, std::index_sequence<I...>) noexcept
-                {
-                    return f(std::move(std::get<I>(t))...);
-                }
-
-                template <typename Function, typename Tuple>
-                inline static auto call(Function f, Tuple &t) noexcept
-                {
-                    static constexpr auto size = std::tuple_size<Tuple>::value;
-                    return call(f, t, std::make_index_sequence<size>{});
-                }
+                using values_t = std::tuple<typename std::decay<Args>::type...>;
 
-            private:
-                struct QueuedData
+                struct Coalesced
                 {
-                    signature_t notify;
-                    std::tuple<Args..., void *> args;
-                    std::weak_ptr<void> lifeline;
+                    std::mutex mutex{};
+                    /* Set while an emission is queued, overwritten by every later emission */
+                    std::unique_ptr<values_t> latest{};
                 };
 
             public:
-                inline Signal() noexcept {}
+                /* `name` labels queued deliveries for the main-loop watchdog */
+                inline Signal(const char *name,
+                              SignalDelivery delivery = SignalDelivery::Every) noexcept
+                  : name_{ name }
+                {
+                    if (delivery == SignalDelivery::Latest)
+                    {
+                        coalesced_ = std::make_shared<Coalesced>();
+                    }
+                }
                 inline ~Signal() noexcept {}
 
             public:
@@ -103,37 +116,73 @@ namespace spring
                     }
                 }
 
+                /* Queues a single event per emission, delivered on the main thread to whoever */
+                /* is connected at that point, unless the signal was destroyed in the meantime */
                 void emit_queued(Args &&... args) const noexcept
                 {
-                    for (const auto &connection : connections_)
+                    std::weak_ptr<void> lifeline{ lifeline_ };
+
+                    if (coalesced_ != nullptr)
                     {
-                        auto data = new QueuedData{ connection.first,
-                                                    std::make_tuple(std::forward<Args>(args)...,
-                                                                    connection.second),
-                                                    lifeline_ };
+                        {
+                            std::lock_guard<std::mutex> lock{ coalesced_->mutex };
+
+                            auto &latest = coalesced_->latest;
+                            if (latest != nullptr)
+                            {
+                                *latest = values_t{ std::forward<Args>(args)... };
+                                return;
+                            }
+                            latest = std::make_unique<values_t>(std::forward<Args>(args)...);
+                        }
 
-                        g_idle_add(
-                            [](void *d) -> int {
-                                auto data =
-                                    std::unique_ptr<QueuedData>{ static_cast<QueuedData *>(d) };
+                        signal_dispatcher::post([this, lifeline] {
+                            auto alive = lifeline.lock();
+                            if (alive != nullptr)
+                            {
+                                main_loop_watchdog::Activity activity{ name_ };
 
-                                if (data->lifeline.lock() != nullptr)
+                                std::unique_ptr<values_t> latest{};
                                 {
-                                    if (data->notify != nullptr)
-                                    {
-                                        call(data->notify, data->args);
-                                    }
+                                    std::lock_guard<std::mutex> lock{ coalesced_->mutex };
+                                    latest.swap(coalesced_->latest);
                                 }
-
-                                return false;
-                            },
-                            data);
+                                deliver(*latest);
+                            }
+                        });
+                    }
+                    else
+                    {
+                        values_t values{ std::forward<Args>(args)... };
+                        signal_dispatcher::post(
+                            [this, lifeline, values = std::move(values)]() mutable {
+                                auto alive = lifeline.lock();
+                                if (alive != nullptr)
+                                {
+                                    main_loop_watchdog::Activity activity{ name_ };
+                                    deliver(values);
+                                }
+                            });
                     }
                 }
 
             private:
+                template <std::size_t... I>
+                inline void deliver(values_t &values, std::index_sequence<I...>) const noexcept
+                {
+                    emit(static_cast<Args &&>(std::get<I>(values))...);
+                }
+
+                inline void deliver(values_t &values) const noexcept
+                {
+                    deliver(values, std::index_sequence_for<Args...>{});
+                }
+
+            private:
+                const char *name_;
                 std::vector<std::pair<signature_t, void *>> connections_{};
                 std::unordered_map<void *, std::size_t> clients_{};
+                std::shared_ptr<Coalesced> coalesced_{};
                 mutable std::shared_ptr<void> lifeline_{ std::make_shared<char>() };
             };
         } // namespace utility
@@ -0,0 +1,21 @@
+#ifndef SPRING_PLAYER_STARTUP_TIMER_H
+#define SPRING_PLAYER_STARTUP_TIMER_H
+
+namespace spring
+{
+    namespace player
+    {
+        namespace utility
+        {
+            namespace startup_timer
+            {
+                /* Records the moment the process started, call as early as possible in main() */
+                void start() noexcept;
+                /* Logs the time-to-interactive the first time any content becomes visible */
+                void content_visible(const char *source) noexcept;
+            } // namespace startup_timer
+        }     // namespace utility
+    }         // namespace player
+} // namespace spring
+
+#endif // !SPRING_PLAYER_STARTUP_TIMER_H
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cstdio>
+
+#include <gtk/gtk.h>
+
+#include <fmt/format.h>
+
+#include <libspring_logger.h>
+#include <libspring_metrics.h>
+
+#include "utility/artwork_loader.h"
+#include "utility/artwork_prefetcher.h"
+#include "utility/async_queue.h"
+#include "utility/global.h"
+#include "utility/settings.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    constexpr std::int64_t HOLD_OFF_US{ 5 * 1000 * 1000 };
+    constexpr std::size_t LOG_EVERY{ 100 };
+
+    struct prefetch_metrics_t
+    {
+        metrics::Gauge &total{ metrics::gauge("spring_artwork_prefetch_items",
+                                              "Albums and artists whose artwork is prefetched",
+                                              "state=\"total\"") };
+        metrics::Gauge &completed{ metrics::gauge("spring_artwork_prefetch_items",
+                                                  "Albums and artists whose artwork is prefetched",
+                                                  "state=\"completed\"") };
+        metrics::Counter &downloaded{ metrics::counter(
+            "spring_artwork_prefetch_downloaded_bytes_total",
+            "Artwork downloaded ahead of time by the prefetcher") };
+    };
+
+    prefetch_metrics_t &prefetch_metrics() noexcept
+    {
+        static prefetch_metrics_t instance{};
+        return instance;
+    }
+
+    /* Holds the id of the last item that was prefetched, for picking up where we left off */
+    std::string state_path() noexcept
+    {
+        return fmt::format("{}/artwork_prefetch", settings::cache_directory());
+    }
+
+    std::string load_last_completed() noexcept
+    {
+        std::string result{};
+
+        gchar *contents{ nullptr };
+        gsize length{ 0 };
+        if (g_file_get_contents(state_path().c_str(), &contents, &length, nullptr))
+        {
+            result.assign(contents, length);
+            g_free(contents);
+        }
+
+        return result;
+    }
+
+    void save_last_completed(const std::string &id) noexcept
+    {
+        if (!g_file_set_contents(state_path().c_str(), id.data(),
+                                 static_cast<gssize>(id.size()), nullptr))
+        {
+            LOG_WARN("ArtworkPrefetcher: Failed to save progress to {}", state_path());
+        }
+    }
+
+    /* The next run goes through the whole library again, for anything added since */
+    void forget_progress() noexcept
+    {
+        async_queue::push_request(async_queue::Priority::Background,
+                                  async_queue::Request{ "forget_artwork_prefetch_progress", [] {
+                                                           std::remove(state_path().c_str());
+                                                       } });
+    }
+} // namespace
+
+ArtworkPrefetcher::ArtworkPrefetcher() noexcept
+{
+    LOG_INFO("ArtworkPrefetcher({}): Creating...", void_p(this));
+}
+
+ArtworkPrefetcher::~ArtworkPrefetcher() noexcept
+{
+    LOG_INFO("ArtworkPrefetcher({}): Destroying...", void_p(this));
+
+    stop();
+}
+
+void ArtworkPrefetcher::start(std::shared_ptr<MusicLibrary> library, int scale_factor) noexcept
+{
+    stop();
+
+    rate_ = settings::artwork_prefetch_rate();
+    if (rate_ == 0)
+    {
+        LOG_INFO("ArtworkPrefetcher({}): Prefetching is disabled", void_p(this));
+        return;
+    }
+
+    lifeline_ = std::make_shared<char>();
+    std::weak_ptr<void> lifeline{ lifeline_ };
+
+    async_queue::push_request(
+        async_queue::Priority::Background,
+        async_queue::Request{ "list_artwork_to_prefetch", [this, lifeline, library,
+                                                              scale_factor] {
+                                 /* The snapshots are good enough and spare the server */
+                                 auto albums = library->cachedAlbums();
+                                 if (albums.empty())
+                                 {
+                                     albums = library->albums();
+                                 }
+                                 auto artists = library->cachedArtists();
+                                 if (artists.empty())
+                                 {
+                                     artists = library->artists();
+                                 }
+
+                                 auto items = std::make_shared<std::vector<item_t>>();
+                                 items->reserve(albums.size() + artists.size());
+                                 for (auto &album : albums)
+                                 {
+                                     auto id = fmt::format("album/{}", album.id());
+                                     items->push_back(
+                                         { std::move(id),
+                                           [album = std::move(album), scale_factor] {
+                                               return prefetch_artwork<200, 200>(
+                                                   "album_artwork", album, scale_factor);
+                                           } });
+                                 }
+                                 for (auto &artist : artists)
+                                 {
+                                     auto id = fmt::format("artist/{}", artist.id());
+                                     items->push_back(
+                                         { std::move(id),
+                                           [artist = std::move(artist), scale_factor] {
+                                               return prefetch_artwork<200, 200>(
+                                                   "artist_artwork", artist, scale_factor);
+                                           } });
+                                 }
+
+                                 /* Starts over if the item is gone, what's cached already */
+                                 /* is skipped quickly anyway                               */
+                                 std::size_t next{ 0 };
+                                 const auto last_completed = load_last_completed();
+                                 for (std::size_t it = 0; it < items->size(); ++it)
+                                 {
+                                     if ((*items)[it].id == last_completed)
+                                     {
+                                         next = it + 1;
+                                         break;
+                                     }
+                                 }
+
+                                 async_queue::post_response(async_queue::Response{
+                                     "artwork_to_prefetch_listed", [this, lifeline, items, next] {
+                                         if (lifeline.lock() != nullptr)
+                                         {
+                                             items_ = std::move(*items);
+                                             next_ = next;
+                                             on_items_listed();
+                                         }
+                                     } });
+                             } });
+}
+
+void ArtworkPrefetcher::stop() noexcept
+{
+    if (source_id_ != 0)
+    {
+        g_source_remove(source_id_);
+        source_id_ = 0;
+    }
+
+    lifeline_.reset();
+    items_.clear();
+    next_ = 0;
+}
+
+void ArtworkPrefetcher::hold_off() noexcept
+{
+    held_off_until_ = g_get_monotonic_time() + HOLD_OFF_US;
+}
+
+ArtworkPrefetcher::Progress ArtworkPrefetcher::progress() const noexcept
+{
+    return { next_, items_.size() };
+}
+
+void ArtworkPrefetcher::on_items_listed() noexcept
+{
+    LOG_INFO("ArtworkPrefetcher({}): Prefetching artwork for {} items, starting at {}",
+             void_p(this), items_.size(), next_);
+
+    prefetch_metrics().total.set(static_cast<std::int64_t>(items_.size()));
+    prefetch_metrics().completed.set(static_cast<std::int64_t>(next_));
+
+    /* Nothing was listed, e.g. offline without snapshots, or the last run was done but */
+    /* quit before its progress was forgotten                                           */
+    if (next_ >= items_.size())
+    {
+        forget_progress();
+        return;
+    }
+
+    schedule_next(0);
+}
+
+void ArtworkPrefetcher::on_item_prefetched(std::size_t bytes) noexcept
+{
+    ++next_;
+
+    prefetch_metrics().completed.set(static_cast<std::int64_t>(next_));
+    prefetch_metrics().downloaded.increment(bytes);
+
+    if (next_ % LOG_EVERY == 0 || next_ == items_.size())
+    {
+        LOG_INFO("ArtworkPrefetcher({}): Prefetched {} of {} items", void_p(this), next_,
+                 items_.size());
+    }
+
+    if (next_ < items_.size())
+    {
+        /* Spaced out so that, on average, downloads stay within the rate */
+        schedule_next(static_cast<std::uint32_t>(bytes * 1000 / rate_));
+    }
+    else
+    {
+        forget_progress();
+    }
+}
+
+void ArtworkPrefetcher::schedule_next(std::uint32_t delay_ms) noexcept
+{
+    const auto now = g_get_monotonic_time();
+    if (held_off_until_ > now)
+    {
+        delay_ms = std::max(delay_ms, static_cast<std::uint32_t>((held_off_until_ - now) / 1000));
+    }
+
+    /* Low priority sources only run once the main loop has nothing else to do */
+    source_id_ = g_timeout_add_full(G_PRIORITY_LOW, delay_ms,
+                                    [](gpointer instance) -> gboolean {
+                                        auto self = static_cast<ArtworkPrefetcher *>(instance);
+                                        self->source_id_ = 0;
+                                        self->prefetch_next();
+                                        return G_SOURCE_REMOVE;
+                                    },
+                                    this, nullptr);
+}
+
+void ArtworkPrefetcher::prefetch_next() noexcept
+{
+    if (next_ >= items_.size())
+    {
+        return;
+    }
+
+    /* hold_off() was called while waiting */
+    if (held_off_until_ > g_get_monotonic_time())
+    {
+        schedule_next(0);
+        return;
+    }
+
+    std::weak_ptr<void> lifeline{ lifeline_ };
+    async_queue::push_request(
+        async_queue::Priority::Background,
+        async_queue::Request{ "prefetch_artwork", [this, lifeline, item = items_[next_]] {
+                                 const auto bytes = item.prefetch();
+                                 save_last_completed(item.id);
+
+                                 async_queue::post_response(async_queue::Response{
+                                     "artwork_prefetched", [this, lifeline, bytes] {
+                                         if (lifeline.lock() != nullptr)
+                                         {
+                                             on_item_prefetched(bytes);
+                                         }
+                                     } });
+                             } });
+}
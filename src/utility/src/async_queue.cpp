@@ -1,29 +1,83 @@
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <gtk/gtk.h>
 
 #include <pthread.h>
 
-#include <blockingconcurrentqueue.h>
+#include <concurrentqueue.h>
 
 #include <libspring_logger.h>
+#include <libspring_trace.h>
 
 #include "utility/async_queue.h"
+#include "utility/async_queue_telemetry.h"
+#include "utility/main_loop_watchdog.h"
 
 using namespace spring;
 using namespace spring::player;
 using namespace spring::player::utility;
-using namespace moodycamel;
 
 namespace
 {
+    constexpr auto PRIORITY_COUNT{ static_cast<std::size_t>(async_queue::Priority::Count) };
+    constexpr std::size_t MIN_WORKER_COUNT{ 2 };
+    constexpr std::size_t MAX_WORKER_COUNT{ 8 };
+
+    /* Each worker owns two deques per priority level. Requests queued by other threads, the */
+    /* main thread mostly, run in the order they were made. Requests a worker spawned itself */
+    /* go on its own deque, where the owner pushes and pops at the back so it keeps working  */
+    /* on what it just started, while thieves take the oldest ones from the front.           */
+    struct Worker
+    {
+        std::mutex mutex{};
+        std::array<std::deque<async_queue::Request>, PRIORITY_COUNT> queued{};
+        std::array<std::deque<async_queue::Request>, PRIORITY_COUNT> spawned{};
+        std::thread thread{};
+    };
+
     std::atomic_bool message_loop_running{ true };
-    BlockingConcurrentQueue<async_queue::Request> message_queue{};
-    ConcurrentQueue<async_queue::Request> prio_queue{};
-    std::thread worker{};
+    std::vector<std::unique_ptr<Worker>> workers{};
+    std::atomic_size_t next_worker{ 0 };
+
+    /* Number of queued requests, workers sleep on the condition variable when it drops to 0 */
+    std::atomic_size_t pending_requests{ 0 };
+    std::mutex sleep_mutex{};
+    std::condition_variable wake_up{};
+
+    thread_local Worker *current_worker{ nullptr };
+    thread_local const async_queue::CancellationToken *current_token{ nullptr };
+
+    /* Token of the most recently queued request for each supersede key */
+    std::mutex supersede_mutex{};
+    std::unordered_map<std::string, async_queue::CancellationToken> latest_requests{};
 
-    constexpr auto SENTINEL_REQUEST_ID{ "6228d6fc-f492-4e09-bc82-2c83d351fe97" };
+    /* Responses posted by the workers, waiting to be run on the main thread */
+    moodycamel::ConcurrentQueue<async_queue::Response> responses{};
+    /* Bumped after a response is enqueued, so the main thread never misses a wake-up */
+    std::atomic_size_t queued_responses{ 0 };
+    /* Set while a drain is pending, workers only wake up the main loop once per batch */
+    std::atomic_bool drain_scheduled{ false };
+
+    /* Time spent running responses in a single frame, leaving the rest for layout and paint */
+    constexpr gint64 FRAME_BUDGET_US{ 4000 };
+
+    /* Only ever touched from the main thread */
+    GtkWidget *frame_clock_widget{ nullptr };
+    GdkFrameClock *frame_clock{ nullptr };
+    gulong frame_clock_handler{ 0 };
+
+    constexpr const char *PRIORITY_NAMES[PRIORITY_COUNT]{ "interactive", "visible",
+                                                          "background" };
 
     inline unsigned long current_thread_id() noexcept { return pthread_self(); }
 
@@ -31,85 +85,344 @@ namespace
     {
         if (request.request == nullptr)
         {
-            if (request.id != SENTINEL_REQUEST_ID)
-            {
-                LOG("AsyncQueue: Received empty request...");
-            }
+            LOG("AsyncQueue: Received empty request...");
         }
         else
         {
-            if (message_loop_running)
+            if (request.token.cancelled())
+            {
+                LOG_INFO("AsyncQueue: Dropping cancelled request \"{}\"", request.id);
+                async_queue::telemetry::request_dropped(request.id);
+            }
+            else if (message_loop_running)
             {
                 LOG_INFO("AsyncQueue: Executing request \"{}\" on thread "
                          "0x{:x}",
                          request.id, current_thread_id());
 
+                const auto started_at = async_queue::telemetry::now();
+
+                trace::Span span{ "async_queue", request.id };
+                span.flowFrom(request.trace_flow);
+
+                current_token = &request.token;
                 request.request();
+                current_token = nullptr;
+
+                span.end();
+
+                async_queue::telemetry::request_finished(request.id, request.queued_at,
+                                                         started_at);
             }
         }
     }
 
-    void send_sentinel_request() noexcept
+    bool pop_local(Worker &worker, std::size_t priority, async_queue::Request &request) noexcept
     {
-        message_queue.enqueue(async_queue::Request{ SENTINEL_REQUEST_ID, nullptr });
+        std::lock_guard<std::mutex> lock{ worker.mutex };
+
+        auto &spawned = worker.spawned[priority];
+        if (!spawned.empty())
+        {
+            request = std::move(spawned.back());
+            spawned.pop_back();
+
+            return true;
+        }
+
+        auto &queued = worker.queued[priority];
+        if (!queued.empty())
+        {
+            request = std::move(queued.front());
+            queued.pop_front();
+
+            return true;
+        }
+
+        return false;
     }
-} // namespace
 
-void async_queue::start_processing() noexcept
-{
-    LOG_INFO("AsyncQueue: Main thread: 0x{:x}", current_thread_id());
-    worker = std::thread{ []() {
-        LOG_INFO("AsyncQueue: Started worker thread 0x{:x}", current_thread_id());
+    bool steal(Worker &thief, std::size_t priority, async_queue::Request &request) noexcept
+    {
+        for (auto &victim : workers)
+        {
+            if (victim.get() == &thief)
+            {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock{ victim->mutex };
+
+            for (auto queue : { &victim->queued[priority], &victim->spawned[priority] })
+            {
+                if (!queue->empty())
+                {
+                    request = std::move(queue->front());
+                    queue->pop_front();
 
-        for (;;)
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool next_request(Worker &worker, async_queue::Request &request) noexcept
+    {
+        for (std::size_t priority = 0; priority < PRIORITY_COUNT; ++priority)
         {
-            Request request;
+            if (pop_local(worker, priority, request) || steal(worker, priority, request))
+            {
+                --pending_requests;
+                async_queue::telemetry::request_dequeued(
+                    static_cast<async_queue::Priority>(priority));
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void process_requests(Worker *worker) noexcept
+    {
+        LOG_INFO("AsyncQueue: Started worker thread 0x{:x}", current_thread_id());
+
+        current_worker = worker;
 
-            if (!prio_queue.try_dequeue(request))
+        while (message_loop_running)
+        {
+            async_queue::Request request{};
+            if (next_request(*worker, request))
             {
-                message_queue.wait_dequeue(request);
+                handle_request(request);
+                continue;
             }
 
-            if (!message_loop_running)
+            std::unique_lock<std::mutex> lock{ sleep_mutex };
+            wake_up.wait(lock, []() { return pending_requests > 0 || !message_loop_running; });
+        }
+    }
+    void run_response(async_queue::Response &response) noexcept
+    {
+        const auto dropped = response.token.cancelled();
+        async_queue::telemetry::response_dequeued(response.id, response.queued_at, dropped);
+
+        if (!dropped)
+        {
+            trace::Span span{ "main_loop", response.id };
+            span.flowFrom(response.trace_flow);
+            main_loop_watchdog::Activity activity{ response.id };
+
+            response.request();
+        }
+        else
+        {
+            LOG_INFO("AsyncQueue: Dropping reply \"{}\" of a cancelled request", response.id);
+        }
+    }
+
+    /* Runs queued responses until the frame budget is used up, returns true if some are left */
+    /* over and another drain needs to be scheduled                                          */
+    bool drain_responses() noexcept
+    {
+        const auto deadline = g_get_monotonic_time() + FRAME_BUDGET_US;
+
+        async_queue::Response response{};
+        while (responses.try_dequeue(response))
+        {
+            --queued_responses;
+            run_response(response);
+            /* Release whatever the callback captured right away */
+            response = async_queue::Response{};
+
+            if (g_get_monotonic_time() >= deadline)
             {
                 break;
             }
+        }
+
+        if (queued_responses > 0)
+        {
+            return true;
+        }
+
+        drain_scheduled = false;
+
+        /* A worker might have posted after the queue was found empty but before the flag was */
+        /* cleared, in which case it relied on the drain that was still pending               */
+        return queued_responses > 0 && !drain_scheduled.exchange(true);
+    }
+
+    void schedule_drain() noexcept;
+
+    void on_frame_clock_update(GdkFrameClock *, gpointer) noexcept
+    {
+        if (drain_responses())
+        {
+            schedule_drain();
+        }
+    }
+
+    void schedule_drain() noexcept
+    {
+        if (frame_clock != nullptr && gtk_widget_get_mapped(frame_clock_widget))
+        {
+            gdk_frame_clock_request_phase(frame_clock, GDK_FRAME_CLOCK_PHASE_UPDATE);
+        }
+        else
+        {
+            g_idle_add(
+                [](gpointer) -> gboolean {
+                    if (drain_responses())
+                    {
+                        schedule_drain();
+                    }
+                    return false;
+                },
+                nullptr);
+        }
+    }
+
+    void on_frame_clock_widget_realized(GtkWidget *widget, gpointer) noexcept
+    {
+        frame_clock = gtk_widget_get_frame_clock(widget);
+        if (frame_clock != nullptr)
+        {
+            frame_clock_handler = g_signal_connect(frame_clock, "update",
+                                                   G_CALLBACK(&on_frame_clock_update), nullptr);
+        }
+    }
 
-            handle_request(request);
+    void on_frame_clock_widget_unrealized(GtkWidget *, gpointer) noexcept
+    {
+        if (frame_clock != nullptr)
+        {
+            g_signal_handler_disconnect(frame_clock, frame_clock_handler);
+            frame_clock = nullptr;
+            frame_clock_handler = 0;
+        }
+
+        /* Anything still queued was waiting for a frame that won't come anymore */
+        if (queued_responses > 0)
+        {
+            schedule_drain();
         }
-    } };
+    }
+
+    void on_frame_clock_widget_destroyed(GtkWidget *, gpointer) noexcept
+    {
+        frame_clock_widget = nullptr;
+    }
+} // namespace
+
+void async_queue::start_processing() noexcept
+{
+    LOG_INFO("AsyncQueue: Main thread: 0x{:x}", current_thread_id());
+
+    const auto worker_count = std::min(
+        MAX_WORKER_COUNT,
+        std::max(MIN_WORKER_COUNT, static_cast<std::size_t>(std::thread::hardware_concurrency())));
+
+    /* All workers need to exist before any of them starts stealing */
+    workers.reserve(worker_count);
+    for (std::size_t it = 0; it < worker_count; ++it)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    for (auto &worker : workers)
+    {
+        worker->thread = std::thread{ &process_requests, worker.get() };
+    }
+
+    /* SPRING_PLAYER_QUEUE_STATS=<seconds> periodically logs where the queue spends its time */
+    auto QUEUE_STATS = getenv("SPRING_PLAYER_QUEUE_STATS");
+    if (QUEUE_STATS != nullptr)
+    {
+        telemetry::set_summary_interval(
+            static_cast<std::uint32_t>(std::strtoul(QUEUE_STATS, nullptr, 10)));
+    }
 }
 
 void async_queue::stop_processing() noexcept
 {
-    if (worker.joinable())
     {
+        std::lock_guard<std::mutex> lock{ sleep_mutex };
         message_loop_running = false;
-        send_sentinel_request();
-        worker.join();
     }
-}
+    wake_up.notify_all();
 
-void async_queue::push_back_request(Request &&request) noexcept
-{
-    if (message_loop_running)
+    for (auto &worker : workers)
     {
-        LOG_INFO("AsyncQueue: Posting message: \"{}\"", request.id);
-        message_queue.enqueue(std::move(request));
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
     }
-    else
+
+    if (getenv("SPRING_PLAYER_QUEUE_STATS") != nullptr)
     {
-        LOG_WARN("AsyncQueue: Queue is not running, message \"{}\" lost", request.id);
+        telemetry::set_summary_interval(0);
+        telemetry::log_summary();
     }
 }
 
-void async_queue::push_front_request(Request &&request) noexcept
+void async_queue::push_request(Priority priority, Request &&request) noexcept
 {
-    if (message_loop_running)
+    if (message_loop_running && !workers.empty())
     {
-        LOG_INFO("AsyncQueue: Posting priority message: \"{}\"", request.id);
-        prio_queue.enqueue(std::move(request));
-        send_sentinel_request();
+        const auto level = static_cast<std::size_t>(priority);
+
+        LOG_INFO("AsyncQueue: Posting {} message: \"{}\"", PRIORITY_NAMES[level], request.id);
+
+        if (request.supersedes != nullptr)
+        {
+            if (!request.token)
+            {
+                request.token = CancellationToken::create();
+            }
+
+            std::lock_guard<std::mutex> lock{ supersede_mutex };
+
+            auto &latest = latest_requests[request.supersedes];
+            if (latest && !latest.cancelled())
+            {
+                LOG_INFO("AsyncQueue: \"{}\" supersedes a pending request", request.id);
+            }
+            latest.cancel();
+            latest = request.token;
+        }
+
+        /* Requests made from a worker stay on that worker, others are spread round-robin */
+        auto worker = current_worker;
+        const auto spawned = worker != nullptr;
+        if (!spawned)
+        {
+            worker = workers[next_worker++ % workers.size()].get();
+        }
+
+        request.queued_at = telemetry::now();
+        telemetry::request_queued(priority);
+
+        if (trace::enabled())
+        {
+            trace::Span span{ "async_queue", "push_request" };
+            span.setDetail(request.id);
+            request.trace_flow = span.flowOut();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ worker->mutex };
+            auto &queue = spawned ? worker->spawned[level] : worker->queued[level];
+            queue.push_back(std::move(request));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ sleep_mutex };
+            ++pending_requests;
+        }
+        wake_up.notify_one();
     }
     else
     {
@@ -117,20 +430,68 @@ void async_queue::push_front_request(Request &&request) noexcept
     }
 }
 
+void async_queue::push_back_request(Request &&request) noexcept
+{
+    push_request(Priority::Visible, std::move(request));
+}
+
+void async_queue::push_front_request(Request &&request) noexcept
+{
+    push_request(Priority::Interactive, std::move(request));
+}
+
 void async_queue::post_response(Response &&response) noexcept
 {
     if (message_loop_running && response.request != nullptr)
     {
+        if (!response.token && current_token != nullptr)
+        {
+            response.token = *current_token;
+        }
+
         LOG_INFO("AsyncQueue: Posting reply: \"{}\"", response.id);
-        auto r = new Response;
-        *r = std::move(response);
-        g_main_context_invoke(
-            nullptr,
-            [](gpointer data) -> int {
-                std::unique_ptr<Response> response{ static_cast<Response *>(data) };
-                response->request();
-                return false;
-            },
-            r);
+        response.queued_at = telemetry::now();
+        telemetry::response_queued();
+
+        if (trace::enabled())
+        {
+            trace::Span span{ "async_queue", "post_response" };
+            span.setDetail(response.id);
+            response.trace_flow = span.flowOut();
+        }
+
+        responses.enqueue(std::move(response));
+        ++queued_responses;
+
+        if (!drain_scheduled.exchange(true))
+        {
+            g_main_context_invoke(nullptr,
+                                  [](gpointer) -> gboolean {
+                                      schedule_drain();
+                                      return false;
+                                  },
+                                  nullptr);
+        }
     }
 }
+
+void async_queue::drain_responses_on_frame_clock(GtkWidget *widget) noexcept
+{
+    frame_clock_widget = widget;
+
+    g_signal_connect_after(widget, "realize", G_CALLBACK(&on_frame_clock_widget_realized),
+                           nullptr);
+    g_signal_connect(widget, "unrealize", G_CALLBACK(&on_frame_clock_widget_unrealized),
+                     nullptr);
+    g_signal_connect(widget, "destroy", G_CALLBACK(&on_frame_clock_widget_destroyed), nullptr);
+
+    if (gtk_widget_get_realized(widget))
+    {
+        on_frame_clock_widget_realized(widget, nullptr);
+    }
+}
+
+bool async_queue::cancelled() noexcept
+{
+    return current_token != nullptr && current_token->cancelled();
+}
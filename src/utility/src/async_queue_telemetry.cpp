@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include <gtk/gtk.h>
+
+#include <libspring_logger.h>
+#include <libspring_metrics.h>
+
+#include "utility/async_queue_telemetry.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+using namespace spring::player::utility::async_queue;
+
+namespace
+{
+    constexpr auto PRIORITY_COUNT{ static_cast<std::size_t>(Priority::Count) };
+
+    struct gauge_t
+    {
+        std::atomic_size_t current{ 0 };
+        std::atomic_size_t peak{ 0 };
+
+        void increment() noexcept
+        {
+            const auto value = ++current;
+
+            auto peak_value = peak.load();
+            while (value > peak_value && !peak.compare_exchange_weak(peak_value, value))
+            {
+            }
+        }
+
+        void decrement() noexcept { --current; }
+
+        telemetry::depth_t get() const noexcept { return { current.load(), peak.load() }; }
+    };
+
+    std::array<gauge_t, PRIORITY_COUNT> request_depth{};
+    gauge_t response_depth{};
+
+    /* Keyed by id rather than by pointer, the same id can come from different string literals */
+    std::mutex stats_mutex{};
+    std::unordered_map<std::string, telemetry::request_stats_t> requests{};
+    std::unordered_map<std::string, telemetry::request_stats_t> responses{};
+
+    std::mutex summary_mutex{};
+    guint summary_source{ 0 };
+
+    /* The same data, exported through the process-wide metrics registry */
+    struct queue_metrics_t
+    {
+        queue_metrics_t() noexcept
+        {
+            const char *PRIORITY_LABELS[PRIORITY_COUNT]{ "priority=\"interactive\"",
+                                                         "priority=\"visible\"",
+                                                         "priority=\"background\"" };
+            for (std::size_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+            {
+                depth[priority] = &metrics::gauge("spring_async_queue_requests_pending",
+                                                  "Requests waiting for a worker",
+                                                  PRIORITY_LABELS[priority]);
+            }
+        }
+
+        std::array<metrics::Gauge *, PRIORITY_COUNT> depth{};
+        metrics::Gauge &responses{ metrics::gauge(
+            "spring_async_queue_replies_pending", "Replies waiting to run on the main thread") };
+        metrics::Counter &dropped{ metrics::counter(
+            "spring_async_queue_requests_dropped_total",
+            "Requests dropped because they were cancelled or superseded") };
+        metrics::Histogram &wait{ metrics::histogram(
+            "spring_async_queue_request_wait_seconds",
+            "Time requests spent queued before a worker picked them up",
+            metrics::latencyBuckets()) };
+        metrics::Histogram &run{ metrics::histogram("spring_async_queue_request_run_seconds",
+                                                    "Time requests spent running on a worker",
+                                                    metrics::latencyBuckets()) };
+        metrics::Histogram &reply_wait{ metrics::histogram(
+            "spring_async_queue_reply_wait_seconds",
+            "Time between posting a reply and it running on the main thread",
+            metrics::latencyBuckets()) };
+    };
+
+    queue_metrics_t &queue_metrics() noexcept
+    {
+        static queue_metrics_t instance{};
+        return instance;
+    }
+
+    void record(telemetry::timing_t &timing, std::int64_t duration_us) noexcept
+    {
+        duration_us = std::max(std::int64_t{ 0 }, duration_us);
+
+        ++timing.count;
+        timing.total_us += duration_us;
+        timing.max_us = std::max(timing.max_us, duration_us);
+
+        std::size_t bucket{ 0 };
+        while (duration_us >= telemetry::histogram_t::upper_bound(bucket))
+        {
+            ++bucket;
+        }
+        ++timing.histogram.buckets[bucket];
+    }
+
+    telemetry::request_stats_t &stats_for(
+        std::unordered_map<std::string, telemetry::request_stats_t> &stats,
+        const char *id) noexcept
+    {
+        auto it = stats.find(id);
+        if (it == stats.end())
+        {
+            it = stats.emplace(id, telemetry::request_stats_t{}).first;
+            it->second.id = id;
+        }
+
+        return it->second;
+    }
+
+    std::vector<telemetry::request_stats_t> sorted(
+        const std::unordered_map<std::string, telemetry::request_stats_t> &stats) noexcept
+    {
+        std::vector<telemetry::request_stats_t> result;
+        result.reserve(stats.size());
+        for (const auto &it : stats)
+        {
+            result.push_back(it.second);
+        }
+
+        /* Whatever kept the queue busy the longest goes first */
+        std::sort(result.begin(), result.end(), [](const auto &left, const auto &right) {
+            return left.wait.total_us + left.run.total_us >
+                   right.wait.total_us + right.run.total_us;
+        });
+
+        return result;
+    }
+
+    void log_timing(const char *name, const telemetry::timing_t &timing) noexcept
+    {
+        if (timing.count == 0)
+        {
+            return;
+        }
+
+        LOG_INFO("AsyncQueue:     {}: avg {}us, p50 <{}us, p95 <{}us, max {}us", name,
+                 timing.total_us / static_cast<std::int64_t>(timing.count),
+                 timing.histogram.percentile(50), timing.histogram.percentile(95),
+                 timing.max_us);
+    }
+} // namespace
+
+std::int64_t telemetry::histogram_t::percentile(std::uint32_t p) const noexcept
+{
+    std::uint64_t total{ 0 };
+    for (auto count : buckets)
+    {
+        total += count;
+    }
+
+    const auto target = (total * std::min(p, std::uint32_t{ 100 }) + 99) / 100;
+
+    std::uint64_t seen{ 0 };
+    for (std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+    {
+        seen += buckets[bucket];
+        if (seen >= target && seen > 0)
+        {
+            return upper_bound(bucket);
+        }
+    }
+
+    return 0;
+}
+
+std::vector<telemetry::request_stats_t> telemetry::request_stats() noexcept
+{
+    std::lock_guard<std::mutex> lock{ stats_mutex };
+    return sorted(requests);
+}
+
+std::vector<telemetry::request_stats_t> telemetry::response_stats() noexcept
+{
+    std::lock_guard<std::mutex> lock{ stats_mutex };
+    return sorted(responses);
+}
+
+telemetry::queue_depth_t telemetry::queue_depth() noexcept
+{
+    queue_depth_t result;
+    for (std::size_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+    {
+        result.requests[priority] = request_depth[priority].get();
+    }
+    result.responses = response_depth.get();
+
+    return result;
+}
+
+void telemetry::log_summary() noexcept
+{
+    const auto depth = queue_depth();
+    LOG_INFO("AsyncQueue: Queue depth (current/peak): interactive {}/{}, visible {}/{}, "
+             "background {}/{}, replies {}/{}",
+             depth.requests[0].current, depth.requests[0].peak, depth.requests[1].current,
+             depth.requests[1].peak, depth.requests[2].current, depth.requests[2].peak,
+             depth.responses.current, depth.responses.peak);
+
+    for (const auto &stats : request_stats())
+    {
+        LOG_INFO("AsyncQueue:   Request \"{}\": {} executed, {} dropped", stats.id,
+                 stats.run.count, stats.dropped);
+        log_timing("waited", stats.wait);
+        log_timing("ran", stats.run);
+    }
+
+    for (const auto &stats : response_stats())
+    {
+        LOG_INFO("AsyncQueue:   Reply \"{}\": {} delivered, {} dropped", stats.id,
+                 stats.wait.count - stats.dropped, stats.dropped);
+        log_timing("waited", stats.wait);
+    }
+}
+
+void telemetry::set_summary_interval(std::uint32_t interval_seconds) noexcept
+{
+    std::lock_guard<std::mutex> lock{ summary_mutex };
+
+    if (summary_source != 0)
+    {
+        g_source_remove(summary_source);
+        summary_source = 0;
+    }
+
+    if (interval_seconds > 0)
+    {
+        summary_source = g_timeout_add_seconds(interval_seconds,
+                                               [](gpointer) -> gboolean {
+                                                   log_summary();
+                                                   return true;
+                                               },
+                                               nullptr);
+    }
+}
+
+std::int64_t telemetry::now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void telemetry::request_queued(Priority priority) noexcept
+{
+    request_depth[static_cast<std::size_t>(priority)].increment();
+    queue_metrics().depth[static_cast<std::size_t>(priority)]->add(1);
+}
+
+void telemetry::request_dequeued(Priority priority) noexcept
+{
+    request_depth[static_cast<std::size_t>(priority)].decrement();
+    queue_metrics().depth[static_cast<std::size_t>(priority)]->add(-1);
+}
+
+void telemetry::request_dropped(const char *id) noexcept
+{
+    queue_metrics().dropped.increment();
+
+    std::lock_guard<std::mutex> lock{ stats_mutex };
+    ++stats_for(requests, id).dropped;
+}
+
+void telemetry::request_finished(const char *id, std::int64_t queued_at,
+                                 std::int64_t started_at) noexcept
+{
+    const auto finished_at = now();
+
+    queue_metrics().wait.observe((started_at - queued_at) / 1000000.0);
+    queue_metrics().run.observe((finished_at - started_at) / 1000000.0);
+
+    std::lock_guard<std::mutex> lock{ stats_mutex };
+
+    auto &stats = stats_for(requests, id);
+    record(stats.wait, started_at - queued_at);
+    record(stats.run, finished_at - started_at);
+}
+
+void telemetry::response_queued() noexcept
+{
+    response_depth.increment();
+    queue_metrics().responses.add(1);
+}
+
+void telemetry::response_dequeued(const char *id, std::int64_t queued_at, bool dropped) noexcept
+{
+    response_depth.decrement();
+    queue_metrics().responses.add(-1);
+
+    const auto delivered_at = now();
+    queue_metrics().reply_wait.observe((delivered_at - queued_at) / 1000000.0);
+
+    std::lock_guard<std::mutex> lock{ stats_mutex };
+
+    auto &stats = stats_for(responses, id);
+    record(stats.wait, delivered_at - queued_at);
+    if (dropped)
+    {
+        ++stats.dropped;
+    }
+}
@@ -0,0 +1,141 @@
+#include <array>
+
+#include "utility/color_palette.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    constexpr std::int32_t LEVEL_BITS{ 4 };
+    constexpr std::int32_t LEVELS{ 1 << LEVEL_BITS };
+    constexpr std::size_t CELL_COUNT{ LEVELS * LEVELS * LEVELS };
+
+    constexpr std::uint8_t TOP_THRESHOLD{ 235 };
+    constexpr std::uint8_t BOTTOM_THRESHOLD{ 30 };
+
+    /* 64 KiB, fine on any thread's stack */
+    struct histogram_t
+    {
+        std::array<std::uint32_t, CELL_COUNT> counts;
+        /* Per cell red, green and blue totals, for the average color of each. Enough for */
+        /* images up to 16 megapixels.                                                     */
+        std::array<std::uint32_t, CELL_COUNT * 3> sums;
+    };
+
+    inline std::size_t cell(std::int32_t red, std::int32_t green, std::int32_t blue) noexcept
+    {
+        return static_cast<std::size_t>((red << (2 * LEVEL_BITS)) | (green << LEVEL_BITS) | blue);
+    }
+
+    /* Kept free of branches so the compiler can vectorize everything but the increments */
+    template <std::int32_t channel_count>
+    void count_pixels(histogram_t &histogram,
+                      const std::uint8_t *pixels,
+                      std::int32_t width,
+                      std::int32_t height,
+                      std::int32_t rowstride) noexcept
+    {
+        constexpr auto shift = 8 - LEVEL_BITS;
+
+        for (std::int32_t y = 0; y < height; ++y)
+        {
+            const auto *pixel = pixels + static_cast<std::size_t>(y) * rowstride;
+            for (std::int32_t x = 0; x < width; ++x, pixel += channel_count)
+            {
+                const std::uint32_t red{ pixel[0] };
+                const std::uint32_t green{ pixel[1] };
+                const std::uint32_t blue{ pixel[2] };
+
+                /* Left out if at least two channels are close to the same extreme */
+                const auto top = (red > TOP_THRESHOLD) + (green > TOP_THRESHOLD) +
+                                 (blue > TOP_THRESHOLD);
+                const auto bottom = (red < BOTTOM_THRESHOLD) + (green < BOTTOM_THRESHOLD) +
+                                    (blue < BOTTOM_THRESHOLD);
+                const std::uint32_t weight = (top < 2) & (bottom < 2);
+
+                const auto index = cell(static_cast<std::int32_t>(red >> shift),
+                                        static_cast<std::int32_t>(green >> shift),
+                                        static_cast<std::int32_t>(blue >> shift));
+                histogram.counts[index] += weight;
+                histogram.sums[index * 3] += red * weight;
+                histogram.sums[index * 3 + 1] += green * weight;
+                histogram.sums[index * 3 + 2] += blue * weight;
+            }
+        }
+    }
+
+    void clear_neighbourhood(histogram_t &histogram, std::size_t index) noexcept
+    {
+        const auto red = static_cast<std::int32_t>(index >> (2 * LEVEL_BITS));
+        const auto green = static_cast<std::int32_t>((index >> LEVEL_BITS) & (LEVELS - 1));
+        const auto blue = static_cast<std::int32_t>(index & (LEVELS - 1));
+
+        for (auto r = red - 1; r <= red + 1; ++r)
+        {
+            for (auto g = green - 1; g <= green + 1; ++g)
+            {
+                for (auto b = blue - 1; b <= blue + 1; ++b)
+                {
+                    if (r >= 0 && r < LEVELS && g >= 0 && g < LEVELS && b >= 0 && b < LEVELS)
+                    {
+                        histogram.counts[cell(r, g, b)] = 0;
+                    }
+                }
+            }
+        }
+    }
+} // namespace
+
+palette_t utility::extract_palette(const std::uint8_t *pixels,
+                                   std::int32_t width,
+                                   std::int32_t height,
+                                   std::int32_t rowstride,
+                                   std::int32_t channel_count) noexcept
+{
+    palette_t result{};
+    if (pixels == nullptr || width <= 0 || height <= 0 ||
+        (channel_count != 3 && channel_count != 4) || rowstride < width * channel_count)
+    {
+        return result;
+    }
+
+    histogram_t histogram{};
+    if (channel_count == 3)
+    {
+        count_pixels<3>(histogram, pixels, width, height, rowstride);
+    }
+    else
+    {
+        count_pixels<4>(histogram, pixels, width, height, rowstride);
+    }
+
+    while (result.size < PALETTE_SIZE)
+    {
+        std::size_t most_common{ 0 };
+        for (std::size_t index = 1; index < CELL_COUNT; ++index)
+        {
+            if (histogram.counts[index] > histogram.counts[most_common])
+            {
+                most_common = index;
+            }
+        }
+
+        const auto count = histogram.counts[most_common];
+        if (count == 0)
+        {
+            break;
+        }
+
+        result.colors[result.size++] = {
+            static_cast<std::uint8_t>(histogram.sums[most_common * 3] / count),
+            static_cast<std::uint8_t>(histogram.sums[most_common * 3 + 1] / count),
+            static_cast<std::uint8_t>(histogram.sums[most_common * 3 + 2] / count)
+        };
+
+        clear_neighbourhood(histogram, most_common);
+    }
+
+    return result;
+}
@@ -0,0 +1,114 @@
+#include <cstring>
+
+#include "utility/content_hash.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    constexpr std::uint64_t PRIME_1{ 0x9e3779b185ebca87ull };
+    constexpr std::uint64_t PRIME_2{ 0xc2b2ae3d27d4eb4full };
+    constexpr std::uint64_t PRIME_3{ 0x165667b19e3779f9ull };
+    constexpr std::uint64_t PRIME_4{ 0x85ebca77c2b2ae63ull };
+    constexpr std::uint64_t PRIME_5{ 0x27d4eb2f165667c5ull };
+
+    inline std::uint64_t rotate_left(std::uint64_t value, int bits) noexcept
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    /* Unaligned little-endian loads, which is what every platform we run on does natively */
+    inline std::uint64_t read_64(const std::uint8_t *data) noexcept
+    {
+        std::uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline std::uint32_t read_32(const std::uint8_t *data) noexcept
+    {
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline std::uint64_t round(std::uint64_t accumulator, std::uint64_t input) noexcept
+    {
+        accumulator += input * PRIME_2;
+        accumulator = rotate_left(accumulator, 31);
+        return accumulator * PRIME_1;
+    }
+
+    inline std::uint64_t merge_round(std::uint64_t accumulator, std::uint64_t value) noexcept
+    {
+        accumulator ^= round(0, value);
+        return accumulator * PRIME_1 + PRIME_4;
+    }
+} // namespace
+
+std::uint64_t utility::content_hash(const void *data, std::size_t size) noexcept
+{
+    auto input = static_cast<const std::uint8_t *>(data);
+    const auto end = input + size;
+
+    std::uint64_t hash;
+    if (size >= 32)
+    {
+        std::uint64_t v1{ PRIME_1 + PRIME_2 };
+        std::uint64_t v2{ PRIME_2 };
+        std::uint64_t v3{ 0 };
+        std::uint64_t v4{ 0 - PRIME_1 };
+
+        const auto limit = end - 32;
+        do
+        {
+            v1 = round(v1, read_64(input));
+            v2 = round(v2, read_64(input + 8));
+            v3 = round(v3, read_64(input + 16));
+            v4 = round(v4, read_64(input + 24));
+            input += 32;
+        } while (input <= limit);
+
+        hash = rotate_left(v1, 1) + rotate_left(v2, 7) + rotate_left(v3, 12) +
+               rotate_left(v4, 18);
+        hash = merge_round(hash, v1);
+        hash = merge_round(hash, v2);
+        hash = merge_round(hash, v3);
+        hash = merge_round(hash, v4);
+    }
+    else
+    {
+        hash = PRIME_5;
+    }
+
+    hash += size;
+
+    for (; input + 8 <= end; input += 8)
+    {
+        hash ^= round(0, read_64(input));
+        hash = rotate_left(hash, 27) * PRIME_1 + PRIME_4;
+    }
+
+    if (input + 4 <= end)
+    {
+        hash ^= std::uint64_t{ read_32(input) } * PRIME_1;
+        hash = rotate_left(hash, 23) * PRIME_2 + PRIME_3;
+        input += 4;
+    }
+
+    for (; input < end; ++input)
+    {
+        hash ^= *input * PRIME_5;
+        hash = rotate_left(hash, 11) * PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
@@ -0,0 +1,494 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#else
+#include <array>
+#endif
+
+#include <libspring_trace.h>
+
+#include "utility/exponential_blur.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    constexpr std::int32_t ALPHA_PRECISION{ 16 };
+    constexpr std::int32_t PARAM_PRECISION{ 7 };
+
+    /* Lines blurred together. Pixel `index` of each of them is kept next to the others in a */
+    /* band buffer, with all four channels, so one position along the lines is 16 bytes.     */
+    constexpr std::int32_t BAND_LINES{ 4 };
+    constexpr std::int32_t BAND_CHANNELS{ 4 };
+    constexpr std::size_t BAND_STRIDE{ BAND_LINES * BAND_CHANNELS };
+    /* Bands handed to a thread at once, makes the transposed writes fill whole cache lines */
+    constexpr std::int32_t BANDS_PER_TASK{ 4 };
+
+    /* The filter is channel += alpha * ((pixel << PARAM_PRECISION) - channel) >> 16. With */
+    /* channels and differences fitting 16 bits, that's a 16 bit high multiply, as long as  */
+    /* alpha does too. Larger ones are stored less 1 << 16, which leaves the product short  */
+    /* by exactly the difference, added back through `correction`.                         */
+    struct coefficients_t
+    {
+        std::int32_t alpha;
+        std::int16_t alpha16;
+        std::int16_t correction;
+    };
+
+    coefficients_t coefficients(std::int32_t radius) noexcept
+    {
+        const auto alpha = static_cast<std::int32_t>((1 << ALPHA_PRECISION) *
+                                                     (1.0 - std::exp(-2.3 / (radius + 1.0))));
+        const auto large = alpha > std::numeric_limits<std::int16_t>::max();
+
+        return { alpha, static_cast<std::int16_t>(large ? alpha - (1 << ALPHA_PRECISION) : alpha),
+                 static_cast<std::int16_t>(large ? -1 : 0) };
+    }
+
+#if defined(__AVX2__)
+    /* The whole band position fits a single register */
+    using lanes_t = __m256i;
+
+    inline lanes_t load(const std::uint8_t *position) noexcept
+    {
+        const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position));
+        return _mm256_slli_epi16(_mm256_cvtepu8_epi16(pixels), PARAM_PRECISION);
+    }
+
+    inline void store(const lanes_t &channels, std::uint8_t *position) noexcept
+    {
+        const auto pixels = _mm256_srai_epi16(channels, PARAM_PRECISION);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(position),
+                         _mm_packus_epi16(_mm256_castsi256_si128(pixels),
+                                          _mm256_extracti128_si256(pixels, 1)));
+    }
+
+    inline lanes_t step(const lanes_t &channels,
+                        const lanes_t &pixels,
+                        const coefficients_t &c) noexcept
+    {
+        const auto difference = _mm256_sub_epi16(pixels, channels);
+        const auto product = _mm256_add_epi16(
+            _mm256_mulhi_epi16(difference, _mm256_set1_epi16(c.alpha16)),
+            _mm256_and_si256(difference, _mm256_set1_epi16(c.correction)));
+        return _mm256_add_epi16(channels, product);
+    }
+#elif defined(__SSE2__)
+    struct lanes_t
+    {
+        __m128i low;
+        __m128i high;
+    };
+
+    inline lanes_t load(const std::uint8_t *position) noexcept
+    {
+        const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position));
+        const auto zero = _mm_setzero_si128();
+        return { _mm_slli_epi16(_mm_unpacklo_epi8(pixels, zero), PARAM_PRECISION),
+                 _mm_slli_epi16(_mm_unpackhi_epi8(pixels, zero), PARAM_PRECISION) };
+    }
+
+    inline void store(const lanes_t &channels, std::uint8_t *position) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(position),
+                         _mm_packus_epi16(_mm_srai_epi16(channels.low, PARAM_PRECISION),
+                                          _mm_srai_epi16(channels.high, PARAM_PRECISION)));
+    }
+
+    inline __m128i step(__m128i channels,
+                        __m128i pixels,
+                        __m128i alpha,
+                        __m128i correction) noexcept
+    {
+        const auto difference = _mm_sub_epi16(pixels, channels);
+        const auto product = _mm_add_epi16(_mm_mulhi_epi16(difference, alpha),
+                                           _mm_and_si128(difference, correction));
+        return _mm_add_epi16(channels, product);
+    }
+
+    inline lanes_t step(const lanes_t &channels,
+                        const lanes_t &pixels,
+                        const coefficients_t &c) noexcept
+    {
+        const auto alpha = _mm_set1_epi16(c.alpha16);
+        const auto correction = _mm_set1_epi16(c.correction);
+        return { step(channels.low, pixels.low, alpha, correction),
+                 step(channels.high, pixels.high, alpha, correction) };
+    }
+#elif defined(__ARM_NEON)
+    struct lanes_t
+    {
+        int16x8_t low;
+        int16x8_t high;
+    };
+
+    inline int16x8_t widen(uint8x8_t pixels) noexcept
+    {
+        return vreinterpretq_s16_u16(vshll_n_u8(pixels, PARAM_PRECISION));
+    }
+
+    inline lanes_t load(const std::uint8_t *position) noexcept
+    {
+        const auto pixels = vld1q_u8(position);
+        return { widen(vget_low_u8(pixels)), widen(vget_high_u8(pixels)) };
+    }
+
+    inline void store(const lanes_t &channels, std::uint8_t *position) noexcept
+    {
+        vst1q_u8(position, vcombine_u8(vqmovun_s16(vshrq_n_s16(channels.low, PARAM_PRECISION)),
+                                       vqmovun_s16(vshrq_n_s16(channels.high, PARAM_PRECISION))));
+    }
+
+    inline int16x8_t step(int16x8_t channels,
+                          int16x8_t pixels,
+                          int16x4_t alpha,
+                          int16x8_t correction) noexcept
+    {
+        const auto difference = vsubq_s16(pixels, channels);
+        const auto high_product =
+            vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(difference), alpha), 16),
+                         vshrn_n_s32(vmull_s16(vget_high_s16(difference), alpha), 16));
+        return vaddq_s16(channels,
+                         vaddq_s16(high_product, vandq_s16(difference, correction)));
+    }
+
+    inline lanes_t step(const lanes_t &channels,
+                        const lanes_t &pixels,
+                        const coefficients_t &c) noexcept
+    {
+        const auto alpha = vdup_n_s16(c.alpha16);
+        const auto correction = vdupq_n_s16(c.correction);
+        return { step(channels.low, pixels.low, alpha, correction),
+                 step(channels.high, pixels.high, alpha, correction) };
+    }
+#else
+    using lanes_t = std::array<std::int32_t, BAND_STRIDE>;
+
+    inline lanes_t load(const std::uint8_t *position) noexcept
+    {
+        lanes_t result;
+        for (std::size_t it = 0; it < BAND_STRIDE; ++it)
+        {
+            result[it] = position[it] << PARAM_PRECISION;
+        }
+        return result;
+    }
+
+    inline void store(const lanes_t &channels, std::uint8_t *position) noexcept
+    {
+        for (std::size_t it = 0; it < BAND_STRIDE; ++it)
+        {
+            position[it] = static_cast<std::uint8_t>(channels[it] >> PARAM_PRECISION);
+        }
+    }
+
+    inline lanes_t step(const lanes_t &channels,
+                        const lanes_t &pixels,
+                        const coefficients_t &c) noexcept
+    {
+        lanes_t result;
+        for (std::size_t it = 0; it < BAND_STRIDE; ++it)
+        {
+            result[it] =
+                channels[it] + ((c.alpha * (pixels[it] - channels[it])) >> ALPHA_PRECISION);
+        }
+        return result;
+    }
+#endif
+
+    /* Forwards from the first pixel, then backwards carrying on from where that ended */
+    void blur_band(std::uint8_t *band, std::int32_t length, const coefficients_t &c) noexcept
+    {
+        auto channels = load(band);
+
+        for (std::int32_t index = 1; index < length; ++index)
+        {
+            auto position = band + index * BAND_STRIDE;
+            channels = step(channels, load(position), c);
+            store(channels, position);
+        }
+
+        for (std::int32_t index = length - 2; index >= 0; --index)
+        {
+            auto position = band + index * BAND_STRIDE;
+            channels = step(channels, load(position), c);
+            store(channels, position);
+        }
+    }
+
+    /* Runs tasks on every core, including the calling thread's. Started on first use. */
+    class WorkerPool
+    {
+    public:
+        static WorkerPool &instance() noexcept
+        {
+            static WorkerPool pool{};
+            return pool;
+        }
+
+        ~WorkerPool() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock{ mutex_ };
+                running_ = false;
+            }
+            work_available_.notify_all();
+
+            for (auto &thread : threads_)
+            {
+                thread.join();
+            }
+        }
+
+    public:
+        void run(std::int32_t task_count, const std::function<void(std::int32_t)> &task) noexcept
+        {
+            std::lock_guard<std::mutex> run_lock{ run_mutex_ };
+
+            {
+                std::lock_guard<std::mutex> lock{ mutex_ };
+                task_ = &task;
+                task_count_ = task_count;
+                next_task_ = 0;
+                pending_tasks_ = task_count;
+                ++generation_;
+            }
+            work_available_.notify_all();
+
+            finish_tasks(run_tasks(task));
+
+            /* Workers still holding on to `task` must be done with it before it goes away */
+            std::unique_lock<std::mutex> lock{ mutex_ };
+            work_done_.wait(lock, [this] { return pending_tasks_ == 0 && active_workers_ == 0; });
+            task_ = nullptr;
+        }
+
+    private:
+        WorkerPool() noexcept
+        {
+            const auto thread_count =
+                std::max(1u, std::thread::hardware_concurrency()) - 1; /* Caller helps */
+
+            threads_.reserve(thread_count);
+            for (std::size_t it = 0; it < thread_count; ++it)
+            {
+                threads_.emplace_back([this] { process_tasks(); });
+            }
+        }
+
+        void process_tasks() noexcept
+        {
+            std::uint64_t generation{ 0 };
+
+            for (;;)
+            {
+                const std::function<void(std::int32_t)> *task{ nullptr };
+                {
+                    std::unique_lock<std::mutex> lock{ mutex_ };
+                    work_available_.wait(lock, [this, generation] {
+                        return !running_ || generation_ != generation;
+                    });
+                    if (!running_)
+                    {
+                        return;
+                    }
+
+                    generation = generation_;
+                    task = task_;
+                    if (task == nullptr)
+                    {
+                        continue;
+                    }
+                    ++active_workers_;
+                }
+
+                finish_tasks(run_tasks(*task), true);
+            }
+        }
+
+        std::int32_t run_tasks(const std::function<void(std::int32_t)> &task) noexcept
+        {
+            std::int32_t completed{ 0 };
+            for (auto index = next_task_++; index < task_count_; index = next_task_++)
+            {
+                task(index);
+                ++completed;
+            }
+
+            return completed;
+        }
+
+        void finish_tasks(std::int32_t completed, bool worker = false) noexcept
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            pending_tasks_ -= completed;
+            if (worker)
+            {
+                --active_workers_;
+            }
+
+            if (pending_tasks_ == 0 && active_workers_ == 0)
+            {
+                work_done_.notify_one();
+            }
+        }
+
+    private:
+        std::vector<std::thread> threads_{};
+
+        /* Only one run() at a time */
+        std::mutex run_mutex_{};
+
+        std::mutex mutex_{};
+        std::condition_variable work_available_{};
+        std::condition_variable work_done_{};
+        bool running_{ true };
+        std::uint64_t generation_{ 0 };
+        const std::function<void(std::int32_t)> *task_{ nullptr };
+        std::atomic<std::int32_t> task_count_{ 0 };
+        std::atomic<std::int32_t> next_task_{ 0 };
+        std::int32_t pending_tasks_{ 0 };
+        std::int32_t active_workers_{ 0 };
+    };
+
+    /* Lines are read from `source`, blurred, and written transposed to `destination` */
+    struct pass_t
+    {
+        const std::uint8_t *source;
+        std::int32_t source_line_stride;
+        std::int32_t line_count;
+        std::int32_t line_length;
+
+        std::uint8_t *destination;
+        std::int32_t destination_line_stride;
+    };
+
+    /* Channel counts are fixed at compile time so the copies below turn into plain moves */
+    template <std::int32_t source_channel_count>
+    inline void gather(const pass_t &pass,
+                       std::int32_t first_line,
+                       std::int32_t lines,
+                       std::uint8_t *band) noexcept
+    {
+        for (std::int32_t line = 0; line < lines; ++line)
+        {
+            auto source = pass.source + (first_line + line) * pass.source_line_stride;
+            auto position = band + line * BAND_CHANNELS;
+            for (std::int32_t index = 0; index < pass.line_length; ++index)
+            {
+                std::memcpy(position, source, source_channel_count);
+                source += source_channel_count;
+                position += BAND_STRIDE;
+            }
+        }
+    }
+
+    /* Line `line` becomes column `first_line + line` */
+    template <std::int32_t destination_channel_count>
+    inline void scatter(const pass_t &pass,
+                        std::int32_t first_line,
+                        std::int32_t lines,
+                        const std::uint8_t *band) noexcept
+    {
+        for (std::int32_t index = 0; index < pass.line_length; ++index)
+        {
+            auto destination = pass.destination + index * pass.destination_line_stride +
+                               first_line * destination_channel_count;
+            auto position = band + index * BAND_STRIDE;
+            if (destination_channel_count == BAND_CHANNELS && lines == BAND_LINES)
+            {
+                std::memcpy(destination, position, BAND_STRIDE);
+                continue;
+            }
+
+            for (std::int32_t line = 0; line < lines; ++line)
+            {
+                std::memcpy(destination + line * destination_channel_count,
+                            position + line * BAND_CHANNELS, destination_channel_count);
+            }
+        }
+    }
+
+    template <std::int32_t source_channel_count, std::int32_t destination_channel_count>
+    void run_pass(const pass_t &pass, const coefficients_t &c) noexcept
+    {
+        const auto band_count = (pass.line_count + BAND_LINES - 1) / BAND_LINES;
+        const auto task_count = (band_count + BANDS_PER_TASK - 1) / BANDS_PER_TASK;
+
+        WorkerPool::instance().run(task_count, [&pass, &c, band_count](std::int32_t task) {
+            thread_local std::vector<std::uint8_t> band{};
+            band.assign(static_cast<std::size_t>(pass.line_length) * BAND_STRIDE, 0);
+
+            const auto last_band = std::min(band_count, (task + 1) * BANDS_PER_TASK);
+            for (auto band_index = task * BANDS_PER_TASK; band_index < last_band; ++band_index)
+            {
+                const auto first_line = band_index * BAND_LINES;
+                const auto lines = std::min(BAND_LINES, pass.line_count - first_line);
+
+                gather<source_channel_count>(pass, first_line, lines, band.data());
+                blur_band(band.data(), pass.line_length, c);
+                scatter<destination_channel_count>(pass, first_line, lines, band.data());
+            }
+        });
+    }
+
+    template <std::int32_t channel_count>
+    void blur(image_data_t pixels,
+              std::int32_t width,
+              std::int32_t height,
+              std::int32_t rowstride,
+              const coefficients_t &c) noexcept
+    {
+        /* Always 4 channels, one row per column of the image */
+        std::vector<std::uint8_t> transposed(static_cast<std::size_t>(width) * height *
+                                             BAND_CHANNELS);
+
+        run_pass<channel_count, BAND_CHANNELS>(
+            { pixels, rowstride, height, width, transposed.data(), height * BAND_CHANNELS }, c);
+        run_pass<BAND_CHANNELS, channel_count>(
+            { transposed.data(), height * BAND_CHANNELS, width, height, pixels, rowstride }, c);
+    }
+} // namespace
+
+void utility::exponential_blur(image_data_t pixels,
+                               std::int32_t width,
+                               std::int32_t height,
+                               std::int32_t rowstride,
+                               std::int32_t channel_count,
+                               std::int32_t radius) noexcept
+{
+    if (pixels == nullptr || width <= 0 || height <= 0 ||
+        (channel_count != 3 && channel_count != 4) || rowstride < width * channel_count)
+    {
+        return;
+    }
+
+    TRACE_SPAN("pixbuf", "Blur");
+
+    const auto c = coefficients(radius);
+    if (channel_count == 3)
+    {
+        blur<3>(pixels, width, height, rowstride, c);
+    }
+    else
+    {
+        blur<4>(pixels, width, height, rowstride, c);
+    }
+}
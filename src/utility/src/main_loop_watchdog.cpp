@@ -0,0 +1,191 @@
+#include <gtk/gtk.h>
+
+#include <fmt/format.h>
+
+#include <libspring_logger.h>
+#include <libspring_metrics.h>
+#include <libspring_trace.h>
+
+#include "utility/main_loop_watchdog.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    /* Everything below is only touched from the main thread */
+    bool running{ false };
+    GMainContext *main_context{ nullptr };
+    GPollFunc original_poll{ nullptr };
+    gint64 budget_us{ 0 };
+
+    /* When poll() last returned, 0 until the first iteration */
+    gint64 iteration_started_at{ 0 };
+    const char *longest_activity{ nullptr };
+    gint64 longest_activity_us{ 0 };
+    /* Bumped by every Activity, a signal handler that opened its own is named after that */
+    std::uint64_t activity_count{ 0 };
+
+    bool on_main_thread() noexcept
+    {
+        return running && g_main_context_is_owner(main_context);
+    }
+
+    void report(gint64 duration_us) noexcept
+    {
+        static auto &iterations = metrics::histogram(
+            "spring_main_loop_iteration_seconds",
+            "Time the main loop spent working between two waits for events",
+            { 0.001, 0.004, 0.008, 0.016, 0.033, 0.066, 0.1, 0.25, 0.5, 1 });
+
+        iterations.observe(duration_us / 1000000.0);
+
+        if (duration_us <= budget_us)
+        {
+            return;
+        }
+
+        const auto source = longest_activity != nullptr ? longest_activity : "unattributed";
+
+        /* Stalls are rare, registering the counter on the spot costs next to nothing */
+        metrics::counter("spring_main_loop_stalls_total",
+                         "Main-loop iterations over budget, by the longest activity in them",
+                         fmt::format("source=\"{}\"", source))
+            .increment();
+
+        LOG_WARN("MainLoopWatchdog: Main loop stalled for {}ms, longest activity \"{}\" took {}ms",
+                 duration_us / 1000, source, longest_activity_us / 1000);
+
+        trace::complete("main_loop", "Stall", trace::now() - duration_us, duration_us, source);
+    }
+
+    /* Nested activities never outlast the ones around them, so the outermost one wins */
+    void record(const char *name, gint64 duration) noexcept
+    {
+        if (duration > longest_activity_us)
+        {
+            longest_activity = name;
+            longest_activity_us = duration;
+        }
+    }
+
+    struct signal_activity_t
+    {
+        /* Interned, it may be reported after the handler was disconnected */
+        const char *name;
+        gint64 started_at;
+        std::uint64_t activity_count;
+        /* Signals can be emitted again from their own handlers */
+        guint depth;
+    };
+
+    void on_signal_marshal_started(gpointer data, GClosure *) noexcept
+    {
+        auto activity = static_cast<signal_activity_t *>(data);
+        if (on_main_thread() && activity->depth++ == 0)
+        {
+            activity->started_at = g_get_monotonic_time();
+            activity->activity_count = activity_count;
+        }
+    }
+
+    void on_signal_marshal_finished(gpointer data, GClosure *) noexcept
+    {
+        auto activity = static_cast<signal_activity_t *>(data);
+        if (activity->depth > 0 && g_main_context_is_owner(main_context) &&
+            --activity->depth == 0 && running && activity->activity_count == activity_count)
+        {
+            record(activity->name, g_get_monotonic_time() - activity->started_at);
+        }
+    }
+
+    void on_signal_closure_finalized(gpointer data, GClosure *) noexcept
+    {
+        delete static_cast<signal_activity_t *>(data);
+    }
+
+    gint poll(GPollFD *fds, guint count, gint timeout) noexcept
+    {
+        if (iteration_started_at != 0)
+        {
+            report(g_get_monotonic_time() - iteration_started_at);
+        }
+
+        longest_activity = nullptr;
+        longest_activity_us = 0;
+
+        const auto result = original_poll(fds, count, timeout);
+
+        iteration_started_at = g_get_monotonic_time();
+
+        return result;
+    }
+} // namespace
+
+void main_loop_watchdog::start(std::uint32_t budget_ms) noexcept
+{
+    if (running)
+    {
+        return;
+    }
+
+    LOG_INFO("MainLoopWatchdog: Watching for iterations over {}ms", budget_ms);
+
+    main_context = g_main_context_default();
+    original_poll = g_main_context_get_poll_func(main_context);
+    budget_us = static_cast<gint64>(budget_ms) * 1000;
+    iteration_started_at = 0;
+    running = true;
+
+    g_main_context_set_poll_func(main_context, &poll);
+}
+
+void main_loop_watchdog::stop() noexcept
+{
+    if (!running)
+    {
+        return;
+    }
+
+    LOG_INFO("MainLoopWatchdog: Stopping");
+
+    g_main_context_set_poll_func(main_context, original_poll);
+    running = false;
+}
+
+main_loop_watchdog::Activity::Activity(const char *name) noexcept
+  : name_{ name }
+{
+    if (on_main_thread())
+    {
+        started_at_ = g_get_monotonic_time();
+    }
+}
+
+main_loop_watchdog::Activity::~Activity() noexcept
+{
+    if (started_at_ < 0)
+    {
+        return;
+    }
+
+    ++activity_count;
+    record(name_, g_get_monotonic_time() - started_at_);
+}
+
+std::uint64_t main_loop_watchdog::connect_signal(void *instance,
+                                                 const char *signal,
+                                                 void (*handler)(),
+                                                 void *user_data) noexcept
+{
+    const auto name = fmt::format("{}::{}", G_OBJECT_TYPE_NAME(instance), signal);
+    auto activity = new signal_activity_t{ g_intern_string(name.c_str()), 0, 0, 0 };
+
+    auto closure = g_cclosure_new(handler, user_data, nullptr);
+    g_closure_add_marshal_guards(closure, activity, &on_signal_marshal_started, activity,
+                                 &on_signal_marshal_finished);
+    g_closure_add_finalize_notifier(closure, activity, &on_signal_closure_finalized);
+
+    return g_signal_connect_closure(instance, signal, closure, false);
+}
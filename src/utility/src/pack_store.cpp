@@ -0,0 +1,751 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <fmt/format.h>
+
+#include <libspring_logger.h>
+
+#include "utility/async_queue.h"
+#include "utility/global.h"
+#include "utility/pack_store.h"
+#include "utility/settings.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    /* Segments are created sparse at their full size and mapped once, so that appending */
+    /* to them never requires remapping. They are also the unit of eviction, which keeps */
+    /* them fairly small.                                                                */
+    constexpr std::uint64_t SEGMENT_CAPACITY{ 16 * 1024 * 1024 };
+    /* Records start at multiples of this within their segment */
+    constexpr std::uint64_t RECORD_ALIGNMENT{ 64 };
+
+    constexpr char INDEX_MAGIC[8]{ 'S', 'P', 'R', 'P', 'A', 'C', 'K', '2' };
+    constexpr char SEGMENT_PREFIX[]{ "segment-" };
+
+    struct index_record_t
+    {
+        std::uint32_t id_size;
+        std::uint32_t segment;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t accessed_at;
+        std::uint32_t reserved;
+    };
+
+    std::mutex stores_mutex{};
+    std::unordered_map<std::string, std::unique_ptr<PackStore>> stores{};
+
+    /* Bytes used by the segments of every open store */
+    std::atomic<std::uint64_t> total_size{ 0 };
+    std::atomic<std::uint64_t> size_limit{ 0 };
+    std::atomic_bool sweep_scheduled{ false };
+
+    constexpr std::uint64_t aligned(std::uint64_t value) noexcept
+    {
+        return (value + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+    }
+
+    std::uint32_t now() noexcept { return static_cast<std::uint32_t>(std::time(nullptr)); }
+
+    bool write_all(std::int32_t fd, const void *data, std::size_t size) noexcept
+    {
+        auto bytes = static_cast<const std::uint8_t *>(data);
+        while (size > 0)
+        {
+            const auto written = write(fd, bytes, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+
+        return true;
+    }
+
+    bool read_file(std::int32_t fd, std::string &contents) noexcept
+    {
+        struct stat stbuf;
+        if (fstat(fd, &stbuf) != 0)
+        {
+            return false;
+        }
+
+        contents.resize(static_cast<std::size_t>(stbuf.st_size));
+
+        std::size_t total{ 0 };
+        while (total < contents.size())
+        {
+            const auto bytes_read = pread(fd, &contents[total], contents.size() - total,
+                                          static_cast<off_t>(total));
+            if (bytes_read < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (bytes_read <= 0)
+            {
+                return false;
+            }
+            total += static_cast<std::size_t>(bytes_read);
+        }
+
+        return true;
+    }
+
+    void append_record(std::string &buffer,
+                       const std::string &id,
+                       std::uint32_t segment,
+                       std::uint64_t offset,
+                       std::uint64_t size,
+                       std::uint32_t accessed_at) noexcept
+    {
+        index_record_t record{ static_cast<std::uint32_t>(id.size()), segment, offset, size,
+                               accessed_at, 0 };
+        buffer.append(reinterpret_cast<const char *>(&record), sizeof(record));
+        buffer.append(id);
+    }
+} // namespace
+
+struct PackStore::Segment
+{
+    ~Segment() noexcept
+    {
+        if (mapping != nullptr)
+        {
+            munmap(mapping, SEGMENT_CAPACITY);
+        }
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    std::int32_t fd{ -1 };
+    std::uint8_t *mapping{ nullptr };
+    std::string path{};
+    /* Where the next record goes, only touched with the store's lock held exclusively */
+    std::uint64_t used{ 0 };
+    /* When a record was last appended, seconds since the epoch */
+    std::int64_t written_at{ 0 };
+    /* Records claimed but not yet indexed, the segment isn't swept until they are */
+    std::uint32_t pending_writes{ 0 };
+};
+
+PackStore &PackStore::open(const string_view &prefix) noexcept
+{
+    std::lock_guard<std::mutex> lock{ stores_mutex };
+
+    if (stores.empty())
+    {
+        size_limit = settings::cache_size_limit();
+        LOG_INFO("PackStore: Cache size limit is {} MiB", size_limit / (1024 * 1024));
+    }
+
+    std::string key{ prefix };
+    auto it = stores.find(key);
+    if (it == stores.end())
+    {
+        auto directory = fmt::format("{}/{}", settings::cache_directory(), prefix);
+        it = stores
+                 .emplace(key, std::unique_ptr<PackStore>{
+                                   new PackStore{ key, std::move(directory) } })
+                 .first;
+    }
+
+    return *it->second;
+}
+
+void PackStore::enforce_size_limit() noexcept
+{
+    sweep_scheduled = false;
+
+    std::size_t segment_count{ 0 };
+    {
+        std::lock_guard<std::mutex> lock{ stores_mutex };
+        for (const auto &store : stores)
+        {
+            std::shared_lock<std::shared_timed_mutex> store_lock{ store.second->mutex_ };
+            segment_count += store.second->segments_.size();
+        }
+    }
+
+    /* Every segment gets swept at most twice: once to clear the reference bits of its */
+    /* records and once more to evict them, if they're still not read by then         */
+    for (std::size_t pass = 0; pass < 2 * segment_count && total_size > size_limit; ++pass)
+    {
+        PackStore *oldest_store{ nullptr };
+        std::uint32_t oldest_segment{ 0 };
+        std::int64_t oldest_written_at{ INT64_MAX };
+
+        {
+            std::lock_guard<std::mutex> lock{ stores_mutex };
+            for (const auto &store : stores)
+            {
+                std::uint32_t number;
+                std::int64_t written_at;
+                if (store.second->oldest_segment(number, written_at) &&
+                    written_at < oldest_written_at)
+                {
+                    oldest_store = store.second.get();
+                    oldest_segment = number;
+                    oldest_written_at = written_at;
+                }
+            }
+        }
+
+        if (oldest_store == nullptr)
+        {
+            break;
+        }
+
+        oldest_store->sweep_segment(oldest_segment);
+    }
+
+    LOG_INFO("PackStore: Cache uses {} MiB of {} MiB", total_size / (1024 * 1024),
+             size_limit / (1024 * 1024));
+}
+
+void PackStore::sync() noexcept
+{
+    std::lock_guard<std::mutex> lock{ stores_mutex };
+    for (const auto &store : stores)
+    {
+        std::unique_lock<std::shared_timed_mutex> store_lock{ store.second->mutex_ };
+        if (store.second->valid_)
+        {
+            store.second->rewrite_index();
+        }
+    }
+}
+
+PackStore::PackStore(std::string prefix, std::string directory) noexcept
+  : prefix_{ std::move(prefix) }
+  , directory_{ std::move(directory) }
+  , size_{ metrics::gauge("spring_resource_cache_bytes", "Disk space used by the cache",
+                          fmt::format("prefix=\"{}\"", prefix_)) }
+  , evictions_{ metrics::counter("spring_resource_cache_evictions_total",
+                                 "Records evicted to keep the cache within its size limit",
+                                 fmt::format("prefix=\"{}\"", prefix_)) }
+  , copied_bytes_{ metrics::counter(
+        "spring_resource_cache_compacted_bytes_total",
+        "Bytes of recently used records copied forward out of swept segments",
+        fmt::format("prefix=\"{}\"", prefix_)) }
+{
+    LOG_INFO("PackStore({}): Opening {}", void_p(this), directory_);
+
+    if (g_mkdir_with_parents(directory_.c_str(), 0755) != 0)
+    {
+        LOG_ERROR("PackStore({}): Failed to create directory {}: {}", void_p(this), directory_,
+                  std::strerror(errno));
+        return;
+    }
+
+    valid_ = load_index();
+}
+
+bool PackStore::put(const string_view &id, const iovec *parts, std::size_t part_count) noexcept
+{
+    if (!append(id, parts, part_count, nullptr))
+    {
+        return false;
+    }
+
+    if (total_size > size_limit && !sweep_scheduled.exchange(true))
+    {
+        LOG_INFO("PackStore: Cache grew past {} MiB, scheduling eviction",
+                 size_limit / (1024 * 1024));
+        async_queue::push_request(async_queue::Priority::Background,
+                                  async_queue::Request{ "enforce_cache_size_limit",
+                                                        [] { enforce_size_limit(); } });
+    }
+
+    return true;
+}
+
+std::pair<PackStore::Record, bool> PackStore::get(const string_view &id) const noexcept
+{
+    std::shared_lock<std::shared_timed_mutex> lock{ mutex_ };
+    if (!valid_)
+    {
+        return { {}, false };
+    }
+
+    auto it = index_.find(std::string{ id });
+    if (it == index_.end())
+    {
+        return { {}, true };
+    }
+
+    const auto &entry = it->second;
+    entry.accessed_at.store(now(), std::memory_order_relaxed);
+
+    const auto segment = segments_.find(entry.location.segment);
+    if (segment == segments_.end())
+    {
+        return { {}, true };
+    }
+
+    return { { segment->second->mapping + entry.location.offset,
+               static_cast<std::size_t>(entry.location.size), segment->second },
+             true };
+}
+
+bool PackStore::append(const string_view &id,
+                       const iovec *parts,
+                       std::size_t part_count,
+                       const location_t *replaces) noexcept
+{
+    std::uint64_t size{ 0 };
+    for (std::size_t it = 0; it < part_count; ++it)
+    {
+        size += parts[it].iov_len;
+    }
+
+    if (size > SEGMENT_CAPACITY)
+    {
+        LOG_ERROR("PackStore({}): Record {} of {} bytes doesn't fit in a segment", void_p(this),
+                  id, size);
+        return false;
+    }
+
+    location_t location{};
+    std::shared_ptr<Segment> segment{};
+    {
+        std::unique_lock<std::shared_timed_mutex> lock{ mutex_ };
+        if (!valid_)
+        {
+            return false;
+        }
+
+        auto last = segments_.rbegin();
+        segment = last->second;
+        if (segment->used + size > SEGMENT_CAPACITY)
+        {
+            segment = open_segment(last->first + 1, true);
+            if (segment == nullptr)
+            {
+                return false;
+            }
+            segments_.emplace(last->first + 1, segment);
+        }
+
+        /* The space is claimed up front so the data can be written without holding the lock */
+        location = { segments_.rbegin()->first, segment->used, size };
+        const auto end = aligned(segment->used + size);
+        total_size += end - segment->used;
+        size_.add(static_cast<std::int64_t>(end - segment->used));
+        segment->used = end;
+        segment->written_at = std::time(nullptr);
+        ++segment->pending_writes;
+    }
+
+    bool written{ true };
+    auto offset = static_cast<off_t>(location.offset);
+    for (std::size_t it = 0; it < part_count && written; ++it)
+    {
+        const auto bytes = static_cast<const std::uint8_t *>(parts[it].iov_base);
+        std::size_t part_written{ 0 };
+        while (part_written < parts[it].iov_len)
+        {
+            const auto result = pwrite(segment->fd, bytes + part_written,
+                                       parts[it].iov_len - part_written, offset);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                LOG_ERROR("PackStore({}): Failed to write record {}: {}", void_p(this), id,
+                          std::strerror(errno));
+                written = false;
+                break;
+            }
+
+            part_written += static_cast<std::size_t>(result);
+            offset += result;
+        }
+    }
+
+    /* Only indexed once the data is in place, readers never see a partial record */
+    std::unique_lock<std::shared_timed_mutex> lock{ mutex_ };
+    --segment->pending_writes;
+
+    if (!written || segments_.count(location.segment) == 0)
+    {
+        return false;
+    }
+
+    std::string key{ id };
+    if (replaces != nullptr)
+    {
+        auto it = index_.find(key);
+        if (it == index_.end() || !(it->second.location == *replaces))
+        {
+            return false;
+        }
+    }
+
+    if (!append_to_index(id, location))
+    {
+        return false;
+    }
+
+    auto &entry = index_[key];
+    entry.location = location;
+    entry.accessed_at = 0;
+
+    return true;
+}
+
+bool PackStore::oldest_segment(std::uint32_t &number, std::int64_t &written_at) const noexcept
+{
+    std::shared_lock<std::shared_timed_mutex> lock{ mutex_ };
+    if (!valid_)
+    {
+        return false;
+    }
+
+    bool found{ false };
+    for (const auto &segment : segments_)
+    {
+        /* Empty segments, like one that was just rotated to, have nothing to evict. Ones */
+        /* still being written to are left for a later pass.                              */
+        if (segment.second->used > 0 && segment.second->pending_writes == 0 &&
+            (!found || segment.second->written_at < written_at))
+        {
+            number = segment.first;
+            written_at = segment.second->written_at;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void PackStore::sweep_segment(std::uint32_t number) noexcept
+{
+    struct candidate_t
+    {
+        std::string id;
+        location_t location;
+    };
+
+    std::shared_ptr<Segment> segment{};
+    std::vector<candidate_t> referenced{};
+    {
+        std::unique_lock<std::shared_timed_mutex> lock{ mutex_ };
+
+        auto it = segments_.find(number);
+        if (it == segments_.end())
+        {
+            return;
+        }
+        segment = it->second;
+
+        /* A put could have claimed space since the segment was picked */
+        if (segment->pending_writes > 0)
+        {
+            return;
+        }
+
+        /* Anything written from now on has to go somewhere else */
+        const auto last = segments_.rbegin()->first;
+        if (number == last)
+        {
+            auto next = open_segment(last + 1, true);
+            if (next == nullptr)
+            {
+                return;
+            }
+            segments_.emplace(last + 1, std::move(next));
+        }
+
+        for (const auto &entry : index_)
+        {
+            if (entry.second.location.segment == number && entry.second.accessed_at != 0)
+            {
+                referenced.push_back({ entry.first, entry.second.location });
+            }
+        }
+    }
+
+    LOG_INFO("PackStore({}): Sweeping {}, {} records get a second chance", void_p(this),
+             segment->path, referenced.size());
+
+    for (const auto &candidate : referenced)
+    {
+        iovec part{ segment->mapping + candidate.location.offset, candidate.location.size };
+        if (append(candidate.id, &part, 1, &candidate.location))
+        {
+            copied_bytes_.increment(candidate.location.size);
+        }
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock{ mutex_ };
+
+    std::uint64_t evicted{ 0 };
+    for (auto it = index_.begin(); it != index_.end();)
+    {
+        if (it->second.location.segment == number)
+        {
+            it = index_.erase(it);
+            ++evicted;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    evictions_.increment(evicted);
+
+    total_size -= segment->used;
+    size_.add(-static_cast<std::int64_t>(segment->used));
+    segments_.erase(number);
+
+    /* Readers holding on to records keep the mapping, unlinking doesn't affect them */
+    unlink(segment->path.c_str());
+    rewrite_index();
+
+    LOG_INFO("PackStore({}): Evicted {} records with {}", void_p(this), evicted, segment->path);
+}
+
+bool PackStore::load_index() noexcept
+{
+    const auto index_path = fmt::format("{}/index", directory_);
+    index_fd_ = ::open(index_path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                       S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (index_fd_ < 0)
+    {
+        LOG_ERROR("PackStore({}): Failed to open {}: {}", void_p(this), index_path,
+                  std::strerror(errno));
+        return false;
+    }
+
+    std::string contents;
+    if (!read_file(index_fd_, contents))
+    {
+        LOG_ERROR("PackStore({}): Failed to read {}: {}", void_p(this), index_path,
+                  std::strerror(errno));
+        return false;
+    }
+
+    /* Anything that isn't an index in the current format is started over */
+    if (contents.size() < sizeof(INDEX_MAGIC) ||
+        std::memcmp(contents.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+    {
+        contents.clear();
+        if (ftruncate(index_fd_, 0) != 0 ||
+            !write_all(index_fd_, INDEX_MAGIC, sizeof(INDEX_MAGIC)))
+        {
+            LOG_ERROR("PackStore({}): Failed to initialize {}: {}", void_p(this), index_path,
+                      std::strerror(errno));
+            return false;
+        }
+    }
+
+    /* Superseded records count too, their data is still taking up space */
+    std::map<std::uint32_t, std::uint64_t> segment_ends{};
+
+    std::size_t position{ contents.empty() ? 0 : sizeof(INDEX_MAGIC) };
+    while (position + sizeof(index_record_t) <= contents.size())
+    {
+        index_record_t record;
+        std::memcpy(&record, contents.data() + position, sizeof(record));
+        if (position + sizeof(record) + record.id_size > contents.size())
+        {
+            break;
+        }
+
+        if (record.offset + record.size <= SEGMENT_CAPACITY)
+        {
+            auto &entry = index_[contents.substr(position + sizeof(record), record.id_size)];
+            entry.location = { record.segment, record.offset, record.size };
+            entry.accessed_at = record.accessed_at;
+
+            auto &end = segment_ends[record.segment];
+            end = std::max(end, aligned(record.offset + record.size));
+        }
+
+        position += sizeof(record) + record.id_size;
+    }
+
+    /* A record cut short by a crash is dropped, later ones are appended after the last */
+    /* complete one                                                                     */
+    if (!contents.empty() && position < contents.size())
+    {
+        LOG_WARN("PackStore({}): Dropping {} bytes of incomplete index records", void_p(this),
+                 contents.size() - position);
+        if (ftruncate(index_fd_, static_cast<off_t>(position)) != 0)
+        {
+            return false;
+        }
+    }
+
+    for (const auto &end : segment_ends)
+    {
+        auto segment = open_segment(end.first, false);
+        if (segment != nullptr)
+        {
+            segment->used = end.second;
+            total_size += segment->used;
+            size_.add(static_cast<std::int64_t>(segment->used));
+            segments_.emplace(end.first, std::move(segment));
+        }
+    }
+
+    for (auto it = index_.begin(); it != index_.end();)
+    {
+        it = segments_.count(it->second.location.segment) == 0 ? index_.erase(it)
+                                                               : std::next(it);
+    }
+
+    /* Segments nothing points to anymore, e.g. when a sweep was interrupted */
+    if (auto directory = opendir(directory_.c_str()))
+    {
+        while (auto file = readdir(directory))
+        {
+            if (std::strncmp(file->d_name, SEGMENT_PREFIX, sizeof(SEGMENT_PREFIX) - 1) == 0)
+            {
+                const auto number = static_cast<std::uint32_t>(
+                    std::strtoul(file->d_name + sizeof(SEGMENT_PREFIX) - 1, nullptr, 10));
+                if (segments_.count(number) == 0)
+                {
+                    LOG_INFO("PackStore({}): Removing orphaned {}", void_p(this), file->d_name);
+                    unlinkat(dirfd(directory), file->d_name, 0);
+                }
+            }
+        }
+        closedir(directory);
+    }
+
+    if (segments_.empty())
+    {
+        const auto number = segment_ends.empty() ? 0 : segment_ends.rbegin()->first + 1;
+        auto segment = open_segment(number, true);
+        if (segment == nullptr)
+        {
+            return false;
+        }
+        segments_.emplace(number, std::move(segment));
+    }
+
+    LOG_INFO("PackStore({}): Loaded {} records from {} segments", void_p(this), index_.size(),
+             segments_.size());
+
+    return true;
+}
+
+bool PackStore::append_to_index(const string_view &id, const location_t &location) noexcept
+{
+    /* One write per record, so a crash can only ever cut off the tail of the index */
+    std::string buffer{};
+    append_record(buffer, std::string{ id }, location.segment, location.offset, location.size,
+                  0);
+
+    if (!write_all(index_fd_, buffer.data(), buffer.size()))
+    {
+        LOG_ERROR("PackStore({}): Failed to index record {}: {}", void_p(this), id,
+                  std::strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+bool PackStore::rewrite_index() noexcept
+{
+    const auto index_path = fmt::format("{}/index", directory_);
+    const auto temporary_path = fmt::format("{}.tmp", index_path);
+
+    std::string contents{ INDEX_MAGIC, sizeof(INDEX_MAGIC) };
+    contents.reserve(sizeof(INDEX_MAGIC) + index_.size() * (sizeof(index_record_t) + 16));
+    for (const auto &entry : index_)
+    {
+        const auto &location = entry.second.location;
+        append_record(contents, entry.first, location.segment, location.offset, location.size,
+                      entry.second.accessed_at);
+    }
+
+    auto fd = ::open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                     S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0 || !write_all(fd, contents.data(), contents.size()) ||
+        std::rename(temporary_path.c_str(), index_path.c_str()) != 0)
+    {
+        LOG_ERROR("PackStore({}): Failed to rewrite {}: {}", void_p(this), index_path,
+                  std::strerror(errno));
+        if (fd >= 0)
+        {
+            close(fd);
+            unlink(temporary_path.c_str());
+        }
+        return false;
+    }
+
+    /* Appends go to the new index from now on */
+    close(index_fd_);
+    index_fd_ = ::open(index_path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    close(fd);
+
+    return index_fd_ >= 0;
+}
+
+std::shared_ptr<PackStore::Segment> PackStore::open_segment(std::uint32_t number,
+                                                            bool create) noexcept
+{
+    auto segment = std::make_shared<Segment>();
+    segment->path = fmt::format("{}/{}{:04}", directory_, SEGMENT_PREFIX, number);
+
+    segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0),
+                         S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (segment->fd < 0)
+    {
+        LOG_ERROR("PackStore({}): Failed to open {}: {}", void_p(this), segment->path,
+                  std::strerror(errno));
+        return nullptr;
+    }
+
+    struct stat stbuf;
+    if (fstat(segment->fd, &stbuf) != 0 ||
+        (static_cast<std::uint64_t>(stbuf.st_size) < SEGMENT_CAPACITY &&
+         ftruncate(segment->fd, static_cast<off_t>(SEGMENT_CAPACITY)) != 0))
+    {
+        LOG_ERROR("PackStore({}): Failed to size {}: {}", void_p(this), segment->path,
+                  std::strerror(errno));
+        return nullptr;
+    }
+    segment->written_at = stbuf.st_mtime;
+
+    auto mapping = mmap(nullptr, SEGMENT_CAPACITY, PROT_READ, MAP_SHARED, segment->fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        LOG_ERROR("PackStore({}): Failed to map {}: {}", void_p(this), segment->path,
+                  std::strerror(errno));
+        return nullptr;
+    }
+    segment->mapping = static_cast<std::uint8_t *>(mapping);
+
+    return segment;
+}
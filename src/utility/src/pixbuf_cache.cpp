@@ -0,0 +1,129 @@
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <libspring_metrics.h>
+
+#include "utility/pixbuf_cache.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    /* Roughly 400 thumbnails at 200x200 */
+    constexpr std::size_t CAPACITY{ 64 * 1024 * 1024 };
+
+    struct entry_t
+    {
+        std::string key;
+        GdkPixbuf *pixbuf;
+        std::size_t size;
+    };
+
+    struct metrics_t
+    {
+        metrics::Counter &hits{ metrics::counter("spring_pixbuf_cache_hits_total",
+                                                 "Lookups served by the in-memory pixbuf cache") };
+        metrics::Counter &misses{ metrics::counter(
+            "spring_pixbuf_cache_misses_total", "Lookups that missed the in-memory pixbuf cache") };
+        metrics::Counter &evictions{ metrics::counter(
+            "spring_pixbuf_cache_evictions_total", "Pixbufs dropped from the in-memory cache") };
+        metrics::Gauge &size{ metrics::gauge("spring_pixbuf_cache_bytes",
+                                             "Pixel data held by the in-memory pixbuf cache") };
+    };
+
+    metrics_t &cache_metrics() noexcept
+    {
+        static metrics_t instance{};
+        return instance;
+    }
+
+    std::mutex mutex{};
+    /* Most recently used first */
+    std::list<entry_t> entries{};
+    std::unordered_map<std::string, std::list<entry_t>::iterator> index{};
+    /* Only hold keys, so they're allowed to outlive what they point to and are cleaned up */
+    /* when found dangling                                                                */
+    std::unordered_map<std::string, std::string> aliases{};
+    std::size_t total_size{ 0 };
+
+    void erase(std::list<entry_t>::iterator it) noexcept
+    {
+        total_size -= it->size;
+        cache_metrics().size.add(-static_cast<std::int64_t>(it->size));
+        g_object_unref(it->pixbuf);
+        index.erase(it->key);
+        entries.erase(it);
+    }
+
+    /* Plain LRU. Shown artwork isn't special here: a GtkImage is given a surface copy of */
+    /* its pixbuf, so evicting the pixbuf does free its memory even while it's on screen. */
+    void evict() noexcept
+    {
+        while (total_size > CAPACITY && !entries.empty())
+        {
+            erase(std::prev(entries.end()));
+            cache_metrics().evictions.increment();
+        }
+    }
+} // namespace
+
+GdkPixbuf *pixbuf_cache::lookup(const std::string &key) noexcept
+{
+    std::lock_guard<std::mutex> lock{ mutex };
+
+    auto it = index.find(key);
+    if (it == index.end())
+    {
+        auto alias = aliases.find(key);
+        if (alias != aliases.end())
+        {
+            it = index.find(alias->second);
+            if (it == index.end())
+            {
+                aliases.erase(alias);
+            }
+        }
+    }
+
+    if (it == index.end())
+    {
+        cache_metrics().misses.increment();
+        return nullptr;
+    }
+
+    cache_metrics().hits.increment();
+    entries.splice(entries.begin(), entries, it->second);
+
+    return GDK_PIXBUF(g_object_ref(it->second->pixbuf));
+}
+
+void pixbuf_cache::insert(const std::string &key, GdkPixbuf *pixbuf) noexcept
+{
+    const auto size = static_cast<std::size_t>(gdk_pixbuf_get_rowstride(pixbuf)) *
+                      static_cast<std::size_t>(gdk_pixbuf_get_height(pixbuf));
+
+    std::lock_guard<std::mutex> lock{ mutex };
+
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        erase(it->second);
+    }
+
+    entries.push_front({ key, GDK_PIXBUF(g_object_ref(pixbuf)), size });
+    index.emplace(key, entries.begin());
+    total_size += size;
+    cache_metrics().size.add(static_cast<std::int64_t>(size));
+
+    evict();
+}
+
+void pixbuf_cache::alias(const std::string &alias, const std::string &key) noexcept
+{
+    std::lock_guard<std::mutex> lock{ mutex };
+    aliases[alias] = key;
+}
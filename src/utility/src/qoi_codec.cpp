@@ -0,0 +1,261 @@
+#include <array>
+#include <cstring>
+
+#include "utility/qoi_codec.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    constexpr std::uint8_t OP_INDEX{ 0x00 };
+    constexpr std::uint8_t OP_DIFF{ 0x40 };
+    constexpr std::uint8_t OP_LUMA{ 0x80 };
+    constexpr std::uint8_t OP_RUN{ 0xc0 };
+    constexpr std::uint8_t OP_RGB{ 0xfe };
+    constexpr std::uint8_t OP_RGBA{ 0xff };
+    constexpr std::uint8_t OP_MASK{ 0xc0 };
+
+    constexpr std::int32_t MAX_RUN{ 62 };
+    /* Also lets the decoder read the longest op without checking for the end every time */
+    constexpr std::array<std::uint8_t, 8> END_MARKER{ 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    struct pixel_t
+    {
+        std::uint8_t r;
+        std::uint8_t g;
+        std::uint8_t b;
+        std::uint8_t a;
+
+        bool operator==(const pixel_t &other) const noexcept
+        {
+            return r == other.r && g == other.g && b == other.b && a == other.a;
+        }
+    };
+
+    inline std::size_t hash(const pixel_t &pixel) noexcept
+    {
+        return (pixel.r * 3u + pixel.g * 5u + pixel.b * 7u + pixel.a * 11u) % 64;
+    }
+
+    inline bool valid(std::int32_t width,
+                      std::int32_t height,
+                      std::int32_t rowstride,
+                      std::int32_t channel_count) noexcept
+    {
+        return width > 0 && height > 0 && (channel_count == 3 || channel_count == 4) &&
+               rowstride >= width * channel_count;
+    }
+} // namespace
+
+std::vector<std::uint8_t> qoi::encode(const std::uint8_t *pixels,
+                                      std::int32_t width,
+                                      std::int32_t height,
+                                      std::int32_t rowstride,
+                                      std::int32_t channel_count) noexcept
+{
+    std::vector<std::uint8_t> result{};
+    if (pixels == nullptr || !valid(width, height, rowstride, channel_count))
+    {
+        return result;
+    }
+
+    /* Worst case is every pixel stored verbatim, reserving that avoids reallocating */
+    result.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) *
+                      (static_cast<std::size_t>(channel_count) + 1) +
+                  END_MARKER.size());
+    auto out = result.data();
+
+    std::array<pixel_t, 64> index{};
+    pixel_t previous{ 0, 0, 0, 255 };
+    pixel_t current{ 0, 0, 0, 255 };
+    std::int32_t run{ 0 };
+
+    for (std::int32_t y = 0; y < height; ++y)
+    {
+        const auto *row = pixels + static_cast<std::size_t>(y) * rowstride;
+        for (std::int32_t x = 0; x < width; ++x)
+        {
+            const auto *pixel = row + x * channel_count;
+            current.r = pixel[0];
+            current.g = pixel[1];
+            current.b = pixel[2];
+            if (channel_count == 4)
+            {
+                current.a = pixel[3];
+            }
+
+            if (current == previous)
+            {
+                if (++run == MAX_RUN)
+                {
+                    *out++ = static_cast<std::uint8_t>(OP_RUN | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0)
+            {
+                *out++ = static_cast<std::uint8_t>(OP_RUN | (run - 1));
+                run = 0;
+            }
+
+            const auto position = hash(current);
+            if (index[position] == current)
+            {
+                *out++ = static_cast<std::uint8_t>(OP_INDEX | position);
+            }
+            else
+            {
+                index[position] = current;
+
+                if (current.a == previous.a)
+                {
+                    const auto dr = static_cast<std::int8_t>(current.r - previous.r);
+                    const auto dg = static_cast<std::int8_t>(current.g - previous.g);
+                    const auto db = static_cast<std::int8_t>(current.b - previous.b);
+                    const auto dr_dg = static_cast<std::int8_t>(dr - dg);
+                    const auto db_dg = static_cast<std::int8_t>(db - dg);
+
+                    if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+                    {
+                        *out++ = static_cast<std::uint8_t>(OP_DIFF | (dr + 2) << 4 |
+                                                           (dg + 2) << 2 | (db + 2));
+                    }
+                    else if (dr_dg > -9 && dr_dg < 8 && dg > -33 && dg < 32 && db_dg > -9 &&
+                             db_dg < 8)
+                    {
+                        *out++ = static_cast<std::uint8_t>(OP_LUMA | (dg + 32));
+                        *out++ = static_cast<std::uint8_t>((dr_dg + 8) << 4 | (db_dg + 8));
+                    }
+                    else
+                    {
+                        *out++ = OP_RGB;
+                        *out++ = current.r;
+                        *out++ = current.g;
+                        *out++ = current.b;
+                    }
+                }
+                else
+                {
+                    *out++ = OP_RGBA;
+                    *out++ = current.r;
+                    *out++ = current.g;
+                    *out++ = current.b;
+                    *out++ = current.a;
+                }
+            }
+
+            previous = current;
+        }
+    }
+
+    if (run > 0)
+    {
+        *out++ = static_cast<std::uint8_t>(OP_RUN | (run - 1));
+    }
+
+    std::memcpy(out, END_MARKER.data(), END_MARKER.size());
+    out += END_MARKER.size();
+
+    result.resize(static_cast<std::size_t>(out - result.data()));
+    result.shrink_to_fit();
+
+    return result;
+}
+
+bool qoi::decode(const std::uint8_t *data,
+                 std::size_t size,
+                 std::uint8_t *pixels,
+                 std::int32_t width,
+                 std::int32_t height,
+                 std::int32_t rowstride,
+                 std::int32_t channel_count) noexcept
+{
+    if (data == nullptr || pixels == nullptr || !valid(width, height, rowstride, channel_count) ||
+        size < END_MARKER.size() ||
+        std::memcmp(data + size - END_MARKER.size(), END_MARKER.data(), END_MARKER.size()) != 0)
+    {
+        return false;
+    }
+
+    /* Ops start before this and are at most 5 bytes long, so they never read past the end */
+    const auto end = data + size - END_MARKER.size();
+
+    std::array<pixel_t, 64> index{};
+    pixel_t pixel{ 0, 0, 0, 255 };
+    std::int32_t run{ 0 };
+
+    for (std::int32_t y = 0; y < height; ++y)
+    {
+        auto *row = pixels + static_cast<std::size_t>(y) * rowstride;
+        for (std::int32_t x = 0; x < width; ++x)
+        {
+            if (run > 0)
+            {
+                --run;
+            }
+            else
+            {
+                if (data >= end)
+                {
+                    return false;
+                }
+
+                const auto op = *data++;
+                if (op == OP_RGB)
+                {
+                    pixel.r = data[0];
+                    pixel.g = data[1];
+                    pixel.b = data[2];
+                    data += 3;
+                }
+                else if (op == OP_RGBA)
+                {
+                    pixel.r = data[0];
+                    pixel.g = data[1];
+                    pixel.b = data[2];
+                    pixel.a = data[3];
+                    data += 4;
+                }
+                else if ((op & OP_MASK) == OP_INDEX)
+                {
+                    pixel = index[op];
+                }
+                else if ((op & OP_MASK) == OP_DIFF)
+                {
+                    pixel.r += ((op >> 4) & 0x03) - 2;
+                    pixel.g += ((op >> 2) & 0x03) - 2;
+                    pixel.b += (op & 0x03) - 2;
+                }
+                else if ((op & OP_MASK) == OP_LUMA)
+                {
+                    const auto dg = (op & 0x3f) - 32;
+                    const auto next = *data++;
+                    pixel.r += dg - 8 + ((next >> 4) & 0x0f);
+                    pixel.g += dg;
+                    pixel.b += dg - 8 + (next & 0x0f);
+                }
+                else
+                {
+                    run = op & 0x3f;
+                }
+
+                index[hash(pixel)] = pixel;
+            }
+
+            auto *out = row + x * channel_count;
+            out[0] = pixel.r;
+            out[1] = pixel.g;
+            out[2] = pixel.b;
+            if (channel_count == 4)
+            {
+                out[3] = pixel.a;
+            }
+        }
+    }
+
+    return data == end;
+}
@@ -33,9 +33,17 @@ namespace
     enum Properties : std::size_t
     {
         PropertyCurrentPage,
+        PropertyMusicSection,
+        PropertyCacheSizeLimit,
+        PropertyCompressArtworkCache,
+        PropertyArtworkPrefetchRate,
         PropertyCount
     };
-    constexpr std::array<const char *, PropertyCount> properties{ "current-page" };
+    constexpr std::array<const char *, PropertyCount> properties{ "current-page",
+                                                                  "music-sections",
+                                                                  "cache-size-limit",
+                                                                  "compress-artwork-cache",
+                                                                  "artwork-prefetch-rate" };
 
     std::string home_directory{};
     std::string data_directory{};
@@ -62,6 +70,68 @@ settings::Page settings::get_current_page() noexcept
     return page;
 }
 
+void settings::set_music_section(const std::string &server, const std::string &key) noexcept
+{
+    LOG_INFO("ApplicationSettings: Saving music section {} of {} to settings", key, server);
+
+    auto sections = g_settings_get_value(app_settings, properties[PropertyMusicSection]);
+
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{ss}"));
+
+    GVariantIter iter;
+    g_variant_iter_init(&iter, sections);
+    const gchar *section_server{ nullptr };
+    const gchar *section_key{ nullptr };
+    while (g_variant_iter_next(&iter, "{&s&s}", &section_server, &section_key))
+    {
+        if (server != section_server)
+        {
+            g_variant_builder_add(&builder, "{ss}", section_server, section_key);
+        }
+    }
+    g_variant_builder_add(&builder, "{ss}", server.c_str(), key.c_str());
+
+    g_settings_set_value(app_settings, properties[PropertyMusicSection],
+                         g_variant_builder_end(&builder));
+    g_variant_unref(sections);
+}
+
+std::string settings::get_music_section(const std::string &server) noexcept
+{
+    auto sections = g_settings_get_value(app_settings, properties[PropertyMusicSection]);
+
+    std::string result{};
+    const gchar *value{ nullptr };
+    if (g_variant_lookup(sections, server.c_str(), "&s", &value))
+    {
+        result = value;
+    }
+    g_variant_unref(sections);
+
+    LOG_INFO("ApplicationSettings: Loaded music section {} of {} from settings", result, server);
+
+    return result;
+}
+
+std::uint64_t settings::cache_size_limit() noexcept
+{
+    const auto limit_mib = g_settings_get_uint(app_settings, properties[PropertyCacheSizeLimit]);
+    return std::uint64_t{ limit_mib } * 1024 * 1024;
+}
+
+bool settings::compress_artwork_cache() noexcept
+{
+    return g_settings_get_boolean(app_settings, properties[PropertyCompressArtworkCache]);
+}
+
+std::uint64_t settings::artwork_prefetch_rate() noexcept
+{
+    const auto rate_kib =
+        g_settings_get_uint(app_settings, properties[PropertyArtworkPrefetchRate]);
+    return std::uint64_t{ rate_kib } * 1024;
+}
+
 const std::string &settings::home_directory() noexcept
 {
     if (::home_directory.empty())
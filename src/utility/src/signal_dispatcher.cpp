@@ -0,0 +1,89 @@
+#include <atomic>
+#include <mutex>
+
+#include <gtk/gtk.h>
+
+#include <concurrentqueue.h>
+
+#include <libspring_logger.h>
+
+#include "utility/signal_dispatcher.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    constexpr std::size_t INITIAL_CAPACITY{ 1024 };
+    constexpr std::size_t DISPATCH_BATCH_SIZE{ 32 };
+
+    /* Each producing thread gets its own sub-queue inside the ConcurrentQueue, so posting */
+    /* an event never contends with the other threads                                     */
+    moodycamel::ConcurrentQueue<signal_dispatcher::Event> events{ INITIAL_CAPACITY };
+    /* Bumped after an event is enqueued, the source stays ready for as long as it's > 0 */
+    std::atomic_size_t pending_events{ 0 };
+    /* Set once the main context was woken up, until the source gets dispatched */
+    std::atomic_bool wakeup_pending{ false };
+
+    std::once_flag source_created{};
+    GMainContext *main_context{ nullptr };
+
+    gboolean prepare(GSource *, gint *timeout) noexcept
+    {
+        *timeout = -1;
+        return pending_events > 0;
+    }
+
+    gboolean check(GSource *) noexcept { return pending_events > 0; }
+
+    gboolean dispatch(GSource *, GSourceFunc, gpointer) noexcept
+    {
+        /* Anything posted from now on needs a new wake-up */
+        wakeup_pending = false;
+
+        signal_dispatcher::Event batch[DISPATCH_BATCH_SIZE];
+        std::size_t count{ 0 };
+        while (pending_events > 0 &&
+               (count = events.try_dequeue_bulk(batch, DISPATCH_BATCH_SIZE)) > 0)
+        {
+            pending_events -= count;
+            for (std::size_t it = 0; it < count; ++it)
+            {
+                batch[it]();
+                batch[it] = nullptr;
+            }
+        }
+
+        return true;
+    }
+
+    GSourceFuncs source_functions{ &prepare, &check, &dispatch, nullptr, nullptr, nullptr };
+
+    void create_source() noexcept
+    {
+        LOG_INFO("SignalDispatcher: Attaching to the main context");
+
+        main_context = g_main_context_default();
+
+        auto source = g_source_new(&source_functions, sizeof(GSource));
+        /* Same priority g_idle_add used to deliver queued signals with */
+        g_source_set_priority(source, G_PRIORITY_DEFAULT_IDLE);
+        g_source_set_name(source, "spring-player signal dispatcher");
+        g_source_attach(source, main_context);
+        g_source_unref(source);
+    }
+} // namespace
+
+void signal_dispatcher::post(Event &&event) noexcept
+{
+    std::call_once(source_created, &create_source);
+
+    events.enqueue(std::move(event));
+    ++pending_events;
+
+    if (!wakeup_pending.exchange(true))
+    {
+        g_main_context_wakeup(main_context);
+    }
+}
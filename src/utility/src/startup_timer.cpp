@@ -0,0 +1,32 @@
+#include <atomic>
+#include <chrono>
+
+#include <libspring_logger.h>
+
+#include "utility/startup_timer.h"
+
+using namespace spring;
+using namespace spring::player;
+using namespace spring::player::utility;
+
+namespace
+{
+    std::chrono::steady_clock::time_point start_time{};
+    std::atomic_bool reported{ false };
+} // namespace
+
+void startup_timer::start() noexcept
+{
+    start_time = std::chrono::steady_clock::now();
+}
+
+void startup_timer::content_visible(const char *source) noexcept
+{
+    if (!reported.exchange(true))
+    {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_time);
+
+        LOG_INFO("StartupTimer: Time to interactive {}ms ({})", elapsed.count(), source);
+    }
+}
@@ -47,6 +47,7 @@ namespace spring
         ~LibrarySection() noexcept;
 
     public:
+        std::string key() const noexcept;
         std::string title() const noexcept;
         Type type() const noexcept;
         MediaLibrary content() const noexcept;
@@ -27,78 +27,190 @@
 #ifndef LIBSPRING_LOGGER_H
 #define LIBSPRING_LOGGER_H
 
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <string>
 
 #include <fmt/format.h>
 
-extern thread_local fmt::MemoryWriter output;
-
 #ifdef _MSC_VER
 #define PATH_SEPARATOR '\\'
 #else
 #define PATH_SEPARATOR '/'
 #endif // _MSC_VER
 
-#define LOG(...)                                                                                   \
-    do                                                                                             \
-    {                                                                                              \
-        output.write("   INFO: {:<20}: {:<4} ** {:<20} **: ",                                      \
-                     strrchr(__FILE__, PATH_SEPARATOR) + 1, __LINE__, __func__);                   \
-        output.write(__VA_ARGS__);                                                                 \
-        output.write("\n");                                                                        \
-        std::fputs(output.c_str(), stderr);                                                        \
-        output.clear();                                                                            \
-    } while (0)
-
-#define LOG_INFO(...) LOG(__VA_ARGS__)
+/* Levels below LIBSPRING_LOG_LEVEL are compiled out entirely: 0 debug, 1 info, 2 warning, */
+/* 3 error, 4 fatal. Defaults to info, or to debug if LIBSPRING_LOG_DEBUG is defined.       */
+#ifndef LIBSPRING_LOG_LEVEL
+#ifdef LIBSPRING_LOG_DEBUG
+#define LIBSPRING_LOG_LEVEL 0
+#else
+#define LIBSPRING_LOG_LEVEL 1
+#endif // LIBSPRING_LOG_DEBUG
+#endif // !LIBSPRING_LOG_LEVEL
 
-#define LOG_WARN(...)                                                                              \
+#define LIBSPRING_LOG_AT(level, ...)                                                               \
     do                                                                                             \
     {                                                                                              \
-        output.write("WARNING: {:<20}: {:<4} ** {:<20} **: ",                                      \
-                     strrchr(__FILE__, PATH_SEPARATOR) + 1, __LINE__, __func__);                   \
-        output.write(__VA_ARGS__);                                                                 \
-        output.write("\n");                                                                        \
-        std::fputs(output.c_str(), stderr);                                                        \
-        output.clear();                                                                            \
+        static const spring::logger::CallSite libspring_log_site{ __FILE__ };                      \
+        if (libspring_log_site.enabled(level))                                                     \
+        {                                                                                          \
+            spring::logger::write(libspring_log_site, level, __LINE__, __func__, __VA_ARGS__);     \
+        }                                                                                          \
     } while (0)
 
-#define LOG_ERROR(...)                                                                             \
+#define LIBSPRING_LOG_DISABLED(...)                                                                \
     do                                                                                             \
     {                                                                                              \
-        output.write("  ERROR: {:<20}: {:<4} ** {:<20} **: ",                                      \
-                     strrchr(__FILE__, PATH_SEPARATOR) + 1, __LINE__, __func__);                   \
-        output.write(__VA_ARGS__);                                                                 \
-        output.write("\n");                                                                        \
-        std::fputs(output.c_str(), stderr);                                                        \
-        output.clear();                                                                            \
     } while (0)
 
+#if LIBSPRING_LOG_LEVEL <= 0
+#define LOG_DEBUG(...) LIBSPRING_LOG_AT(spring::logger::Level::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LIBSPRING_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if LIBSPRING_LOG_LEVEL <= 1
+#define LOG(...) LIBSPRING_LOG_AT(spring::logger::Level::Info, __VA_ARGS__)
+#else
+#define LOG(...) LIBSPRING_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#define LOG_INFO(...) LOG(__VA_ARGS__)
+
+#if LIBSPRING_LOG_LEVEL <= 2
+#define LOG_WARN(...) LIBSPRING_LOG_AT(spring::logger::Level::Warning, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LIBSPRING_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if LIBSPRING_LOG_LEVEL <= 3
+#define LOG_ERROR(...) LIBSPRING_LOG_AT(spring::logger::Level::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LIBSPRING_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+/* Always synchronous, everything logged so far is flushed before the process exits */
 #define LOG_FATAL(...)                                                                             \
     do                                                                                             \
     {                                                                                              \
-        output.write("  FATAL: {:<20}: {:<4} ** {:<20} **: ",                                      \
-                     strrchr(__FILE__, PATH_SEPARATOR) + 1, __LINE__, __func__);                   \
-        output.write(__VA_ARGS__);                                                                 \
-        output.write("\n");                                                                        \
-        std::fputs(output.c_str(), stderr);                                                        \
+        static const spring::logger::CallSite libspring_log_site{ __FILE__ };                      \
+        spring::logger::write(libspring_log_site, spring::logger::Level::Fatal, __LINE__,          \
+                              __func__, __VA_ARGS__);                                              \
         std::exit(EXIT_FAILURE);                                                                   \
     } while (0)
 
-#ifdef LIBSPRING_LOG_DEBUG
-#define LOG_DEBUG(...)                                                                             \
-    do                                                                                             \
-    {                                                                                              \
-        output.write("  DEBUG: {:<20}: {:<4} ** {:<20} **: ",                                      \
-                     strrchr(__FILE__, PATH_SEPARATOR) + 1, __LINE__, __func__);                   \
-        output.write(__VA_ARGS__);                                                                 \
-        output.write("\n");                                                                        \
-        std::fputs(output.c_str(), stderr);                                                        \
-        output.clear();                                                                            \
-    } while (0)
-#else
-#define LOG_DEBUG(...)
-#endif // LIBSPRING_LOG_DEBUG
+namespace spring
+{
+    namespace logger
+    {
+        enum class Level : std::uint8_t
+        {
+            Debug,
+            Info,
+            Warning,
+            Error,
+            Fatal,
+            Off
+        };
+
+        /* Modules are named after the source file the message comes from, without the */
+        /* extension, e.g. "libspring_http_client". "*" sets the level of every module  */
+        /* without one of its own. The initial levels can be set through LIBSPRING_LOG, */
+        /* as a comma separated list of module=level pairs, e.g. "*=warning,buffer=info" */
+        void setLevel(const char *module, Level level) noexcept;
+        Level level(const char *module) noexcept;
+
+        /* Blocks until everything logged so far was written out */
+        void flush() noexcept;
+
+        class CallSite
+        {
+            friend void setLevel(const char *module, Level level) noexcept;
+
+        public:
+            explicit CallSite(const char *path) noexcept;
+
+        public:
+            inline bool enabled(Level level) const noexcept
+            {
+                if (generation_.load(std::memory_order_relaxed) !=
+                    levelsGeneration_.load(std::memory_order_acquire))
+                {
+                    update();
+                }
+
+                return level >= level_.load(std::memory_order_relaxed);
+            }
+
+            inline const char *file() const noexcept { return file_; }
+
+        private:
+            void update() const noexcept;
+
+        private:
+            /* Bumped by setLevel(), call sites look their level up again when it changes */
+            static std::atomic<std::uint32_t> levelsGeneration_;
+
+        private:
+            const char *file_;
+            mutable std::atomic<std::uint32_t> generation_{ 0 };
+            mutable std::atomic<Level> level_{ Level::Info };
+        };
+
+        namespace internal
+        {
+            using Formatter = fmt::BasicFormatter<char>;
+
+            struct argument_t
+            {
+                fmt::internal::Arg arg;
+                /* Types fmt can only format through a pointer to them are formatted right */
+                /* away, everything else is copied into the record and formatted later     */
+                std::string formatted;
+            };
+
+            template <typename T> inline argument_t makeArgument(const T &value) noexcept
+            {
+                argument_t result{ fmt::internal::MakeArg<Formatter>(value), {} };
+                if (result.arg.type == fmt::internal::Arg::CUSTOM)
+                {
+                    result.formatted = fmt::format("{}", value);
+                }
+
+                return result;
+            }
+
+            void enqueue(const CallSite &site,
+                         Level level,
+                         int line,
+                         const char *function,
+                         fmt::CStringRef format,
+                         const argument_t *arguments,
+                         std::size_t count) noexcept;
+        } // namespace internal
+
+        /* Copies the message and its arguments into a per-thread ring buffer, the actual */
+        /* formatting and writing to stderr happens on a background thread              */
+        template <typename... Args>
+        inline void write(const CallSite &site,
+                          Level level,
+                          int line,
+                          const char *function,
+                          fmt::CStringRef format,
+                          const Args &... args) noexcept
+        {
+            static_assert(sizeof...(Args) < fmt::ArgList::MAX_PACKED_ARGS,
+                          "Too many arguments for a log message");
+
+            const internal::argument_t arguments[sizeof...(Args) + 1]{
+                internal::makeArgument(args)..., {}
+            };
+            internal::enqueue(site, level, line, function, format, arguments, sizeof...(Args));
+        }
+    } // namespace logger
+} // namespace spring
 
 #endif // LIBSPRING_LOGGER_H
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBSPRING_METRICS_H
+#define LIBSPRING_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace spring
+{
+    /* Process-wide numeric telemetry. Metrics are registered once, usually into a function */
+    /* local static reference, and updated with relaxed atomics from any thread afterwards. */
+    /*                                                                                      */
+    /* The registry is exported in the Prometheus text format:                              */
+    /*   LIBSPRING_METRICS_ENDPOINT=unix:<path> serves it over a Unix socket                */
+    /*   LIBSPRING_METRICS_ENDPOINT=<port> serves it on 127.0.0.1:<port>                    */
+    /*   LIBSPRING_METRICS_DUMP=<path> writes it to a file when the process exits           */
+    /* Both endpoints answer plain HTTP GET requests, e.g. curl --unix-socket <path> /metrics */
+    namespace metrics
+    {
+        class Counter
+        {
+        public:
+            inline void increment(std::uint64_t count = 1) noexcept
+            {
+                value_.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            inline std::uint64_t value() const noexcept
+            {
+                return value_.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<std::uint64_t> value_{ 0 };
+        };
+
+        class Gauge
+        {
+        public:
+            inline void set(std::int64_t value) noexcept
+            {
+                value_.store(value, std::memory_order_relaxed);
+            }
+
+            inline void add(std::int64_t delta) noexcept
+            {
+                value_.fetch_add(delta, std::memory_order_relaxed);
+            }
+
+            inline std::int64_t value() const noexcept
+            {
+                return value_.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<std::int64_t> value_{ 0 };
+        };
+
+        class Histogram
+        {
+        public:
+            /* `bounds` are the inclusive upper bounds of each bucket, in ascending order */
+            explicit Histogram(std::vector<double> bounds) noexcept;
+
+        public:
+            void observe(double value) noexcept;
+
+            inline const std::vector<double> &bounds() const noexcept { return bounds_; }
+            /* Not cumulative, the last bucket counts everything above the last bound */
+            std::vector<std::uint64_t> buckets() const noexcept;
+            std::uint64_t count() const noexcept;
+            double sum() const noexcept;
+
+        private:
+            Histogram(const Histogram &) = delete;
+            Histogram &operator=(const Histogram &) = delete;
+
+        private:
+            std::vector<double> bounds_;
+            std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+            std::atomic<std::uint64_t> sum_{ 0 };
+        };
+
+        /* 1ms up to ~30s, for latencies measured in seconds */
+        std::vector<double> latencyBuckets() noexcept;
+
+        /* Registering the same name and labels again returns the existing metric. `labels` */
+        /* are in the exposition format, e.g. `prefix="artwork"`, and names are expected to */
+        /* be unique across metric types.                                                   */
+        Counter &counter(const std::string &name,
+                         const std::string &help,
+                         const std::string &labels = {}) noexcept;
+        Gauge &gauge(const std::string &name,
+                     const std::string &help,
+                     const std::string &labels = {}) noexcept;
+        Histogram &histogram(const std::string &name,
+                             const std::string &help,
+                             std::vector<double> bounds,
+                             const std::string &labels = {}) noexcept;
+
+        /* Every registered metric in the Prometheus text exposition format */
+        std::string render() noexcept;
+        bool dump(const std::string &path) noexcept;
+    } // namespace metrics
+} // namespace spring
+
+#endif // LIBSPRING_METRICS_H
@@ -44,27 +44,32 @@ namespace spring
         class Album
         {
         public:
-            Album(AlbumPrivate *priv) noexcept;
+            Album(std::shared_ptr<AlbumPrivate> priv) noexcept;
             ~Album() noexcept;
 
             Album(Album &&other) noexcept;
             Album &operator=(Album &&other) noexcept;
 
+            DEFAULT_COPY(Album)
+
         public:
             const std::string &id() const noexcept;
-            const std::string &title() const noexcept;
-            const std::string &artist() const noexcept;
-            const std::string &genre() const noexcept;
+            /* Everything but the id is refreshed whenever the album is listed again, so it's */
+            /* returned by value                                                              */
+            std::string title() const noexcept;
+            std::string artist() const noexcept;
+            std::string genre() const noexcept;
             std::size_t songCount() const noexcept;
+            /* Server side path of the artwork, changes whenever the image does */
+            std::string artworkPath() const noexcept;
             /* Just assume the image is a JPEG for now... */
-            const std::string &artwork() const noexcept;
+            std::string artwork() const noexcept;
+            /* Artwork resized by the server to fit in width x height, not cached */
+            std::string artwork(std::uint32_t width, std::uint32_t height) const noexcept;
             std::vector<Track> tracks() const noexcept;
 
         private:
-            std::unique_ptr<AlbumPrivate> priv_;
-
-        private:
-            DISABLE_COPY(Album)
+            std::shared_ptr<AlbumPrivate> priv_;
         };
     } // namespace music
 } // namespace spring
@@ -27,6 +27,7 @@
 #ifndef LIBSPRING_MUSIC_ARTIST_H
 #define LIBSPRING_MUSIC_ARTIST_H
 
+#include <cstdint>
 #include <memory>
 
 #include <libspring_global.h>
@@ -42,28 +43,33 @@ namespace spring
         class Artist
         {
         public:
-            Artist(ArtistPrivate *priv) noexcept;
+            Artist(std::shared_ptr<ArtistPrivate> priv) noexcept;
             ~Artist() noexcept;
 
             Artist(Artist &&other) noexcept;
             Artist &operator=(Artist &&other) noexcept;
 
+            DEFAULT_COPY(Artist)
+
         public:
             const std::string &id() const noexcept;
-            const std::string &name() const noexcept;
-            const std::string &summary() const noexcept;
-            const std::string &country() const noexcept;
-            const std::string &genre() const noexcept;
+            /* Everything but the id is refreshed whenever the artist is listed again, so it's */
+            /* returned by value                                                               */
+            std::string name() const noexcept;
+            std::string summary() const noexcept;
+            std::string country() const noexcept;
+            std::string genre() const noexcept;
             std::vector<Album> albums() const noexcept;
             std::vector<Track> tracks() const noexcept;
             std::vector<Track> popularTracks(std::size_t count) const noexcept;
-            const std::string &artwork() const noexcept;
-
-        private:
-            std::unique_ptr<ArtistPrivate> priv_;
+            /* Server side path of the artwork, changes whenever the image does */
+            std::string artworkPath() const noexcept;
+            std::string artwork() const noexcept;
+            /* Artwork resized by the server to fit in width x height, not cached */
+            std::string artwork(std::uint32_t width, std::uint32_t height) const noexcept;
 
         private:
-            DISABLE_COPY(Artist)
+            std::shared_ptr<ArtistPrivate> priv_;
         };
     } // namespace music
 } // namespace spring
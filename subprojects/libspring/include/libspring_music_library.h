@@ -28,8 +28,11 @@
 #define LIBSPRING_MUSIC_LIBRARY_H
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <libspring_error.h>
 #include <libspring_global.h>
 #include <libspring_music_album.h>
 #include <libspring_music_artist.h>
@@ -48,6 +51,16 @@ namespace spring
         using Genre = spring::music::Genre;
         using Track = spring::music::Track;
 
+    public:
+        struct ArtistSummary
+        {
+            std::size_t albumCount;
+            std::size_t trackCount;
+        };
+
+        /* Keyed by Artist::id() */
+        using ArtistSummaries = std::unordered_map<std::string, ArtistSummary>;
+
     public:
         MusicLibrary(MusicLibraryPrivate *priv) noexcept;
         ~MusicLibrary() noexcept;
@@ -56,11 +69,26 @@ namespace spring
         MusicLibrary &operator=(MusicLibrary &&other) noexcept;
 
     public:
-        std::vector<Album> albums() const noexcept;
-        std::vector<Artist> artists() const noexcept;
+        /* Listings that fail leave the snapshot alone and come back empty, with the reason */
+        /* in `error` if one is given                                                        */
+        std::vector<Album> albums(Error *error = nullptr) const noexcept;
+        std::vector<Artist> artists(Error *error = nullptr) const noexcept;
         std::vector<Genre> genres() const noexcept;
         std::vector<Track> tracks() const noexcept;
 
+        /* Album and track counts for every artist in the library, grouped locally from a */
+        /* single listing of the section's albums                                          */
+        ArtistSummaries artistSummaries(Error *error = nullptr) const noexcept;
+
+    public:
+        /* When enabled, every listing fetched from the server is also written to a binary */
+        /* snapshot in the given directory. The cached* variants read the last snapshot    */
+        /* back without touching the network.                                              */
+        void enableSnapshots(const std::string &directory) noexcept;
+        std::vector<Album> cachedAlbums() const noexcept;
+        std::vector<Artist> cachedArtists() const noexcept;
+        ArtistSummaries cachedArtistSummaries() const noexcept;
+
     private:
         std::unique_ptr<MusicLibraryPrivate> priv_;
 
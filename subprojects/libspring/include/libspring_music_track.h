@@ -28,6 +28,7 @@
 #define LIBSPRING_MUSIC_TRACK_H
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -46,29 +47,31 @@ namespace spring
             using Seconds = std::chrono::seconds;
 
         public:
-            explicit Track(TrackPrivate *priv) noexcept;
+            explicit Track(std::shared_ptr<TrackPrivate> priv) noexcept;
             ~Track() noexcept;
 
             Track(Track &&other) noexcept;
             Track &operator=(Track &&other) noexcept;
 
+            DEFAULT_COPY(Track)
+
         public:
-            const std::string &title() const noexcept;
-            const std::string &album() const noexcept;
-            const std::string &artist() const noexcept;
+            /* Refreshed whenever the track is listed again, so it's all returned by value */
+            std::string title() const noexcept;
+            std::string album() const noexcept;
+            std::string artist() const noexcept;
             Milliseconds duration() const noexcept;
-            const std::string &filePath() const noexcept;
+            std::string filePath() const noexcept;
             std::size_t fileSize() const noexcept;
-            const std::string &artwork() const noexcept;
+            std::string artwork() const noexcept;
+            /* Artwork resized by the server to fit in width x height, not cached */
+            std::string artwork(std::uint32_t width, std::uint32_t height) const noexcept;
             std::string url(std::uint32_t bitrate = 320) const noexcept;
             void trackData(DataFragmentReadyCallback callback, Seconds offset, void *userData) const
                 noexcept;
 
         private:
-            std::unique_ptr<TrackPrivate> priv_;
-
-        private:
-            DISABLE_COPY(Track)
+            std::shared_ptr<TrackPrivate> priv_;
         };
     } // namespace music
 } // namespace spring
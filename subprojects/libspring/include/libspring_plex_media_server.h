@@ -35,6 +35,7 @@
 #include <libspring_error.h>
 #include <libspring_global.h>
 #include <libspring_library_section.h>
+#include <libspring_music_library.h>
 #include <libspring_optional.h>
 
 namespace spring
@@ -73,6 +74,8 @@ namespace spring
         const std::string &name() const noexcept;
 
         std::vector<LibrarySection> sections() const noexcept;
+        /* Opens a music section by key without listing the sections on the server first */
+        MusicLibrary musicLibrary(const std::string &sectionKey) const noexcept;
         std::string customRequest(const char *path) const noexcept;
 
     private:
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBSPRING_TRACE_H
+#define LIBSPRING_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define LIBSPRING_TRACE_CONCAT_IMPL(a, b) a##b
+#define LIBSPRING_TRACE_CONCAT(a, b) LIBSPRING_TRACE_CONCAT_IMPL(a, b)
+
+/* Traces the rest of the enclosing scope */
+#define TRACE_SPAN(...)                                                                            \
+    spring::trace::Span LIBSPRING_TRACE_CONCAT(libspring_trace_span_, __LINE__) { __VA_ARGS__ }
+
+namespace spring
+{
+    /* Records Chrome trace events (chrome://tracing, ui.perfetto.dev) when LIBSPRING_TRACE */
+    /* is set to the path of the file to write them to. Otherwise every call below boils   */
+    /* down to a single load, so tracing can stay compiled in.                             */
+    namespace trace
+    {
+        namespace internal
+        {
+            enum State : int
+            {
+                Uninitialized = -1,
+                Disabled,
+                Enabled
+            };
+
+            extern std::atomic_int state;
+            /* Reads LIBSPRING_TRACE and opens the output on first use, instead of during */
+            /* static initialization                                                      */
+            bool initialize() noexcept;
+        } // namespace internal
+
+        inline bool enabled() noexcept
+        {
+            const auto state = internal::state.load(std::memory_order_acquire);
+            return state == internal::Enabled ||
+                   (state == internal::Uninitialized && internal::initialize());
+        }
+
+        /* Microseconds on the clock used for all events */
+        std::int64_t now() noexcept;
+
+        /* Identifies a flow arrow between two spans, possibly on different threads */
+        std::uint64_t newFlowId() noexcept;
+
+        /* Records a span after the fact, e.g. for phases measured by someone else */
+        void complete(const char *category,
+                      const char *name,
+                      std::int64_t start,
+                      std::int64_t duration,
+                      const std::string &detail = {}) noexcept;
+
+        void instant(const char *category,
+                     const char *name,
+                     const std::string &detail = {}) noexcept;
+
+        class Span
+        {
+        public:
+            /* `category` and `name` have to outlive the span, string literals are the norm */
+            inline Span(const char *category, const char *name) noexcept
+              : category_{ category }
+              , name_{ name }
+            {
+                if (enabled())
+                {
+                    start_ = now();
+                }
+            }
+
+            inline ~Span() noexcept { end(); }
+
+        public:
+            inline bool active() const noexcept { return start_ >= 0; }
+
+            /* Shown in the span's arguments */
+            inline void setDetail(std::string &&detail) noexcept
+            {
+                if (active())
+                {
+                    detail_ = std::move(detail);
+                }
+            }
+
+            /* Starts a flow arrow in this span, pass the id to flowFrom() on the other end */
+            std::uint64_t flowOut() noexcept;
+            /* Ends the arrow started by flowOut() in this span */
+            void flowFrom(std::uint64_t id) noexcept;
+
+            void end() noexcept;
+
+        private:
+            Span(const Span &) = delete;
+            Span &operator=(const Span &) = delete;
+
+        private:
+            const char *category_;
+            const char *name_;
+            std::int64_t start_{ -1 };
+            std::string detail_{};
+        };
+    } // namespace trace
+} // namespace spring
+
+#endif // LIBSPRING_TRACE_H
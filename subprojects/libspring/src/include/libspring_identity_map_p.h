@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBSPRING_IDENTITY_MAP_P_H
+#define LIBSPRING_IDENTITY_MAP_P_H
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "libspring_global.h"
+
+namespace spring
+{
+    /* Maps a Plex ratingKey to the single live instance of an entity. The map only holds weak */
+    /* references, an entry dies together with the last Album/Artist/Track that refers to it   */
+    /* and expired entries are swept whenever the map doubles in size.                         */
+    template <typename Entity> class IdentityMap
+    {
+    public:
+        IdentityMap() noexcept = default;
+
+    public:
+        /* For freshly fetched metadata. If the entity is alive it's updated with the result of */
+        /* create(), so everything holding on to it sees the new metadata.                      */
+        template <typename Factory>
+        std::shared_ptr<Entity> get(const std::string &ratingKey, Factory &&create) noexcept
+        {
+            bool created{ false };
+            auto result = lookup(ratingKey, create, created);
+            if (!created)
+            {
+                /* Outside of the map's lock, updating takes the entity's own */
+                result->update(std::move(*create()));
+            }
+
+            return result;
+        }
+
+        /* For metadata that may be older than the live instance, e.g. read from a snapshot. */
+        /* create() is only called if the entity is not alive.                                */
+        template <typename Factory>
+        std::shared_ptr<Entity> getCached(const std::string &ratingKey, Factory &&create) noexcept
+        {
+            bool created{ false };
+            return lookup(ratingKey, create, created);
+        }
+
+    private:
+        template <typename Factory>
+        std::shared_ptr<Entity> lookup(const std::string &ratingKey,
+                                       Factory &create,
+                                       bool &created) noexcept
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+
+            auto &entry = entries_[ratingKey];
+            auto result = entry.lock();
+            if (result == nullptr)
+            {
+                result = create();
+                entry = result;
+                created = true;
+
+                if (entries_.size() >= sweepThreshold_)
+                {
+                    sweep();
+                }
+            }
+
+            return result;
+        }
+
+    private:
+        void sweep() noexcept
+        {
+            for (auto it = entries_.begin(); it != entries_.end();)
+            {
+                it = it->second.expired() ? entries_.erase(it) : std::next(it);
+            }
+
+            sweepThreshold_ = std::max(MIN_SWEEP_THRESHOLD, entries_.size() * 2);
+        }
+
+    private:
+        static constexpr std::size_t MIN_SWEEP_THRESHOLD{ 256 };
+
+    private:
+        std::mutex mutex_{};
+        std::unordered_map<std::string, std::weak_ptr<Entity>> entries_{};
+        std::size_t sweepThreshold_{ MIN_SWEEP_THRESHOLD };
+
+    private:
+        DISABLE_COPY(IdentityMap)
+        DISABLE_MOVE(IdentityMap)
+    };
+
+    template <typename Entity> constexpr std::size_t IdentityMap<Entity>::MIN_SWEEP_THRESHOLD;
+} // namespace spring
+
+#endif // !LIBSPRING_IDENTITY_MAP_P_H
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBSPRING_LIBRARY_SNAPSHOT_P_H
+#define LIBSPRING_LIBRARY_SNAPSHOT_P_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "libspring_global.h"
+
+namespace spring
+{
+    /* A snapshot is a compact, versioned, binary image of a library listing. It consists of a */
+    /* fixed size header, followed by an array of fixed width records and a string table. All  */
+    /* strings in a record are stored as (offset, length) pairs into the string table, so the  */
+    /* whole file can be memory mapped and read in place without any parsing.                  */
+    class LibrarySnapshot
+    {
+    public:
+        static constexpr std::uint32_t MAGIC{ 0x534c5053 }; /* "SPLS" */
+        static constexpr std::uint16_t VERSION{ 2 };
+
+        enum class Kind : std::uint16_t
+        {
+            Albums = 1,
+            Artists = 2
+        };
+
+        struct string_ref_t
+        {
+            std::uint32_t offset;
+            std::uint32_t length;
+        };
+
+        struct header_t
+        {
+            std::uint32_t magic;
+            std::uint16_t version;
+            std::uint16_t kind;
+            std::uint32_t recordSize;
+            std::uint32_t recordCount;
+            std::uint64_t stringTableOffset;
+            std::uint64_t stringTableSize;
+        };
+
+        struct album_record_t
+        {
+            string_ref_t key;
+            string_ref_t title;
+            string_ref_t artist;
+            string_ref_t artistKey;
+            string_ref_t thumb;
+            string_ref_t genre;
+            std::uint64_t leafCount;
+        };
+
+        struct artist_record_t
+        {
+            string_ref_t key;
+            string_ref_t title;
+            string_ref_t summary;
+            string_ref_t thumb;
+            string_ref_t country;
+            string_ref_t genre;
+            std::int32_t librarySectionId;
+            std::uint32_t reserved;
+        };
+
+    public:
+        class Writer
+        {
+        public:
+            explicit Writer(Kind kind) noexcept;
+
+        public:
+            string_ref_t addString(const std::string &value) noexcept;
+            template <typename Record> void addRecord(const Record &record) noexcept
+            {
+                auto data = reinterpret_cast<const char *>(&record);
+                records_.append(data, sizeof(Record));
+                recordSize_ = sizeof(Record);
+                ++recordCount_;
+            }
+
+            bool save(const std::string &path) const noexcept;
+
+        private:
+            Kind kind_;
+            std::uint32_t recordSize_{ 0 };
+            std::uint32_t recordCount_{ 0 };
+            std::string records_{};
+            std::string strings_{};
+        };
+
+    public:
+        LibrarySnapshot(const std::string &path, Kind kind, std::uint32_t recordSize) noexcept;
+        ~LibrarySnapshot() noexcept;
+
+    public:
+        inline bool valid() const noexcept { return header_ != nullptr; }
+        inline std::size_t count() const noexcept
+        {
+            return header_ != nullptr ? header_->recordCount : 0;
+        }
+
+        template <typename Record> inline const Record &record(std::size_t index) const noexcept
+        {
+            return reinterpret_cast<const Record *>(data_ + sizeof(header_t))[index];
+        }
+
+        std::string string(const string_ref_t &ref) const noexcept;
+
+    private:
+        const char *data_{ nullptr };
+        std::size_t size_{ 0 };
+        const header_t *header_{ nullptr };
+
+    private:
+        DISABLE_COPY(LibrarySnapshot)
+        DISABLE_MOVE(LibrarySnapshot)
+    };
+} // namespace spring
+
+#endif // !LIBSPRING_LIBRARY_SNAPSHOT_P_H
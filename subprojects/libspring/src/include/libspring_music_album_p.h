@@ -29,6 +29,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -42,6 +43,8 @@ namespace spring
 
     namespace music
     {
+        class TrackPrivate;
+
         class AlbumPrivate
         {
         public:
@@ -60,10 +63,11 @@ namespace spring
                         ATTRIBUTE(std::string, key)
                         ATTRIBUTE(std::string, title)
                         ATTRIBUTE(std::string, parentTitle)
+                        ATTRIBUTE(std::string, parentKey) /* artist */
                         ATTRIBUTE(std::string, thumb)
                         ATTRIBUTE(std::size_t, leafCount)
                         ATTRIBUTE(std::vector<genre_t>, Genre)
-                        INIT_ATTRIBUTES(key, title, parentTitle, thumb, leafCount, Genre)
+                        INIT_ATTRIBUTES(key, title, parentTitle, parentKey, thumb, leafCount, Genre)
                     };
 
                     ATTRIBUTE(std::vector<metadata_t>, Metadata)
@@ -82,6 +86,10 @@ namespace spring
                          std::weak_ptr<PlexMediaServerPrivate> pms) noexcept;
             ~AlbumPrivate() noexcept;
 
+        public:
+            /* Takes over the metadata of a newer listing of the same album */
+            void update(AlbumPrivate &&other) noexcept;
+
         private:
             std::string key_{};
             std::string id_{};
@@ -91,6 +99,12 @@ namespace spring
             std::size_t songCount_{ 0 };
             std::string artworkPath_{};
             std::string artworkData_{};
+            bool tracksLoaded_{ false };
+            std::vector<std::shared_ptr<TrackPrivate>> tracks_{};
+
+            /* Instances are shared through the identity map and updated in place, guards */
+            /* everything but the key and id                                              */
+            std::mutex mutex_{};
 
             std::weak_ptr<PlexMediaServerPrivate> pms_;
 
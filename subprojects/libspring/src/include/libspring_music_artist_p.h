@@ -28,6 +28,7 @@
 #define LIBSPRING_MUSIC_ARTIST_P_H
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -41,6 +42,8 @@ namespace spring
 
     namespace music
     {
+        class AlbumPrivate;
+
         class ArtistPrivate
         {
         public:
@@ -89,6 +92,10 @@ namespace spring
                           std::weak_ptr<PlexMediaServerPrivate> pms) noexcept;
             ~ArtistPrivate() noexcept;
 
+        public:
+            /* Takes over the metadata of a newer listing of the same artist */
+            void update(ArtistPrivate &&other) noexcept;
+
         private:
             std::string key_{};
             std::string id_{};
@@ -99,6 +106,12 @@ namespace spring
             std::string thumbnailPath_{};
             std::int32_t librarySectionId_{};
             std::string artworkData_{};
+            bool albumsLoaded_{ false };
+            std::vector<std::shared_ptr<AlbumPrivate>> albums_{};
+
+            /* Instances are shared through the identity map and updated in place, guards */
+            /* everything but the key and id                                              */
+            std::mutex mutex_{};
 
             std::weak_ptr<PlexMediaServerPrivate> pms_{};
 
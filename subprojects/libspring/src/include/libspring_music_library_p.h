@@ -28,6 +28,7 @@
 #define LIBSPRING_MUSIC_LIBRARY_P_H
 
 #include <memory>
+#include <string>
 
 #include <sequential.h>
 
@@ -45,9 +46,13 @@ namespace spring
                             std::weak_ptr<PlexMediaServerPrivate> pms) noexcept;
         ~MusicLibraryPrivate() noexcept;
 
+    private:
+        std::string snapshotPath(const char *listing) const noexcept;
+
     private:
         std::string key_;
         std::weak_ptr<PlexMediaServerPrivate> pms_;
+        std::string snapshotDirectory_{};
 
     private:
         DISABLE_COPY(MusicLibraryPrivate)
@@ -29,6 +29,7 @@
 
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -103,7 +104,13 @@ namespace spring
                          std::weak_ptr<PlexMediaServerPrivate> pms) noexcept;
             ~TrackPrivate() noexcept;
 
+        public:
+            /* Takes over the metadata of a newer listing of the same track */
+            void update(TrackPrivate &&other) noexcept;
+
             std::string path(Seconds offset = Seconds{ 0 }, uint32_t bitrate = 320) const noexcept;
+            /* The track's own thumb, or the album's for tracks that don't have one */
+            std::string artworkPath(PlexMediaServerPrivate &pms) const noexcept;
 
         private:
             std::string key_{};
@@ -118,6 +125,10 @@ namespace spring
             std::string artworkPath_{};
             std::string artworkData_{};
 
+            /* Instances are shared through the identity map and updated in place, guards */
+            /* everything but the path                                                    */
+            mutable std::mutex mutex_{};
+
             std::weak_ptr<PlexMediaServerPrivate> pms_;
 
         private:
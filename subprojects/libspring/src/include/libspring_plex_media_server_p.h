@@ -27,16 +27,27 @@
 #ifndef LIBSPRING_PLEX_MEDIA_SERVER_P_H
 #define LIBSPRING_PLEX_MEDIA_SERVER_P_H
 
+#include <future>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <sequential.h>
 
 #include "libspring_error.h"
 #include "libspring_global.h"
 #include "libspring_http_client_p.h"
+#include "libspring_identity_map_p.h"
 
 namespace spring
 {
+    namespace music
+    {
+        class AlbumPrivate;
+        class ArtistPrivate;
+        class TrackPrivate;
+    } // namespace music
+
     class PlexMediaServerPrivate
     {
     public:
@@ -90,6 +101,31 @@ namespace spring
 
         HttpClient::Request request() const noexcept;
         HttpClient::RequestResult request(std::string &&path) const noexcept;
+        /* Same as request(), but concurrent requests for the same path share one transfer */
+        HttpClient::RequestResult sharedRequest(std::string &&path) const noexcept;
+
+        /* Asks the Plex photo transcoder for a copy of the image at path that fits in width x */
+        /* height, falls back to the original image if the transcoder is not available          */
+        std::string resizedImage(const std::string &path,
+                                 std::uint32_t width,
+                                 std::uint32_t height) const noexcept;
+
+        std::string albumThumbnailPath(const std::string &albumRatingKey) const noexcept;
+        void setAlbumThumbnailPath(const std::string &albumRatingKey,
+                                   const std::string &path) noexcept;
+
+        /* Extracts the ratingKey from a metadata key of the form /library/metadata/<id>[/...] */
+        static std::string ratingKey(const std::string &key) noexcept;
+
+        /* Logs what couldn't be fetched, fills in `error` if given and returns true if the */
+        /* request failed or the server didn't answer with OK                               */
+        static bool requestFailed(const HttpClient::RequestResult &r,
+                                  const char *what,
+                                  Error *error = nullptr) noexcept;
+
+        inline IdentityMap<music::AlbumPrivate> &albums() noexcept { return albums_; }
+        inline IdentityMap<music::ArtistPrivate> &artists() noexcept { return artists_; }
+        inline IdentityMap<music::TrackPrivate> &tracks() noexcept { return tracks_; }
 
     private:
         HttpClient http_{ USER_AGENT };
@@ -98,6 +134,17 @@ namespace spring
         std::string clientUUID_{ "6sha3edzskjda732qmdwsjk" };
         std::string name_{};
 
+        IdentityMap<music::AlbumPrivate> albums_{};
+        IdentityMap<music::ArtistPrivate> artists_{};
+        IdentityMap<music::TrackPrivate> tracks_{};
+
+        mutable std::mutex inFlightMutex_{};
+        mutable std::unordered_map<std::string, std::shared_future<HttpClient::RequestResult>>
+            inFlight_{};
+
+        mutable std::mutex albumThumbnailsMutex_{};
+        std::unordered_map<std::string, std::string> albumThumbnails_{};
+
     private:
         DISABLE_COPY(PlexMediaServerPrivate)
         DISABLE_MOVE(PlexMediaServerPrivate)
@@ -13,6 +13,9 @@ namespace spring
             bool operator()(const std::string &s1, const std::string &s2) const;
             bool operator()(const char *s1, const char *s2) const;
         };
+
+        /* Percent-encodes everything except the RFC 3986 unreserved characters */
+        std::string urlEncode(const std::string &value) noexcept;
     } // namespace utilities
 } // namespace spring
 
@@ -31,6 +31,8 @@
 #include <iostream>
 
 #include "libspring_logger.h"
+#include "libspring_metrics.h"
+#include "libspring_trace.h"
 #include "libspring_vla_p.h"
 
 using namespace spring;
@@ -172,6 +174,68 @@ namespace
         }
         return size * nmemb;
     }
+
+    /* Splits a finished transfer into the phases CUrl keeps timings for. Each timing is the */
+    /* number of seconds from the start of the transfer until the end of that phase.        */
+    void tracePhases(CURL *handle, std::int64_t start) noexcept
+    {
+        static constexpr std::pair<CURLINFO, const char *> PHASES[]{
+            { CURLINFO_NAMELOOKUP_TIME, "DNS lookup" },
+            { CURLINFO_CONNECT_TIME, "Connect" },
+            { CURLINFO_APPCONNECT_TIME, "TLS handshake" },
+            { CURLINFO_PRETRANSFER_TIME, "Prepare transfer" },
+            { CURLINFO_STARTTRANSFER_TIME, "Wait for response" },
+            { CURLINFO_TOTAL_TIME, "Receive response" }
+        };
+
+        std::int64_t previous{ 0 };
+        for (const auto &phase : PHASES)
+        {
+            double seconds{ 0 };
+            curl_easy_getinfo(handle, phase.first, &seconds);
+
+            /* Phases that didn't happen, e.g. TLS for plain HTTP, are reported as 0 */
+            const auto end = static_cast<std::int64_t>(seconds * 1000000);
+            if (end > previous)
+            {
+                trace::complete("http", phase.second, start + previous, end - previous);
+                previous = end;
+            }
+        }
+    }
+
+    void recordMetrics(CURL *handle, CURLcode result, std::int32_t httpStatus) noexcept
+    {
+        static const char HELP[]{ "HTTP requests made by libspring, by outcome" };
+        static auto &succeeded = metrics::counter("spring_http_requests_total", HELP,
+                                                  "result=\"success\"");
+        static auto &rejected = metrics::counter("spring_http_requests_total", HELP,
+                                                 "result=\"http_error\"");
+        static auto &failed = metrics::counter("spring_http_requests_total", HELP,
+                                               "result=\"transport_error\"");
+        static auto &duration = metrics::histogram(
+            "spring_http_request_duration_seconds",
+            "Time from starting an HTTP request until its response was fully received",
+            metrics::latencyBuckets());
+        static auto &received =
+            metrics::counter("spring_http_received_bytes_total", "Bytes received over HTTP");
+
+        if (result != CURLE_OK)
+        {
+            failed.increment();
+            return;
+        }
+
+        (httpStatus >= 400 ? rejected : succeeded).increment();
+
+        double seconds{ 0 };
+        curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &seconds);
+        duration.observe(seconds);
+
+        curl_off_t bytes{ 0 };
+        curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+        received.increment(static_cast<std::uint64_t>(bytes));
+    }
 } // namespace
 
 HttpClient::Status::Status(std::int32_t code) noexcept
@@ -652,6 +716,9 @@ HttpClient::http_request_result_t HttpClient::Request::send(write_callback_t cal
 
     if (handle_ != nullptr)
     {
+        trace::Span span{ "http", "Request" };
+        span.setDetail(std::string{ path_ });
+
         std::string url = fmt::format("{}{}", url_, path_);
         curl_easy_setopt(handle_, CURLOPT_URL, url.c_str());
         curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION, &writeCallback<CallbackData>);
@@ -668,12 +735,20 @@ HttpClient::http_request_result_t HttpClient::Request::send(write_callback_t cal
         curl_easy_setopt(handle_, CURLOPT_WRITEDATA, &callbackData);
         curl_easy_setopt(handle_, CURLOPT_HEADERDATA, &responseHeaders);
 
+        const auto performStart = trace::now();
         auto errCode = curl_easy_perform(handle_);
         err = fromCUrlError(errCode);
 
         curl_easy_getinfo(handle_, CURLINFO_RESPONSE_CODE, &httpStatus);
         curl_easy_getinfo(handle_, CURLINFO_TOTAL_TIME, &elapsed);
 
+        recordMetrics(handle_, errCode, httpStatus);
+
+        if (span.active())
+        {
+            tracePhases(handle_, performStart);
+        }
+
         curl_slist_free_all(headers);
     }
 
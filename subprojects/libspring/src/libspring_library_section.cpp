@@ -66,6 +66,11 @@ LibrarySection::LibrarySection(LibrarySectionPrivate *priv) noexcept
 
 LibrarySection::~LibrarySection() noexcept = default;
 
+std::string LibrarySection::key() const noexcept
+{
+    return priv_->key;
+}
+
 std::string LibrarySection::title() const noexcept
 {
     return priv_->title;
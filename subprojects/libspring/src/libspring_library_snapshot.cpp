@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
+#include "libspring_library_snapshot_p.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "libspring_logger.h"
+
+using namespace spring;
+
+constexpr std::uint32_t LibrarySnapshot::MAGIC;
+constexpr std::uint16_t LibrarySnapshot::VERSION;
+
+LibrarySnapshot::Writer::Writer(Kind kind) noexcept
+  : kind_(kind)
+{
+}
+
+LibrarySnapshot::string_ref_t LibrarySnapshot::Writer::addString(const std::string &value) noexcept
+{
+    string_ref_t result{ static_cast<std::uint32_t>(strings_.size()),
+                         static_cast<std::uint32_t>(value.size()) };
+    strings_.append(value);
+
+    return result;
+}
+
+bool LibrarySnapshot::Writer::save(const std::string &path) const noexcept
+{
+    header_t header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.kind = static_cast<std::uint16_t>(kind_);
+    header.recordSize = recordSize_;
+    header.recordCount = recordCount_;
+    header.stringTableOffset = sizeof(header_t) + records_.size();
+    header.stringTableSize = strings_.size();
+
+    /* Write to a temporary file and rename it over the old snapshot, a reader that has the */
+    /* previous version mapped keeps seeing consistent data. Every writer gets its own      */
+    /* temporary file, the same snapshot can be saved from more than one thread at once.    */
+#ifndef PLATFORM_WINDOWS
+    std::string temporaryPath = path + ".XXXXXX";
+    std::FILE *file = nullptr;
+    auto fd = mkstemp(&temporaryPath[0]);
+    if (fd >= 0)
+    {
+        file = fdopen(fd, "wb");
+        if (file == nullptr)
+        {
+            auto error = errno;
+            close(fd);
+            std::remove(temporaryPath.c_str());
+            errno = error;
+        }
+    }
+#else
+    static std::atomic<std::uint32_t> writers{ 0 };
+    const auto temporaryPath = path + ".tmp" + std::to_string(writers++);
+    auto file = std::fopen(temporaryPath.c_str(), "wb");
+#endif
+    if (file == nullptr)
+    {
+        auto error = errno;
+        LOG_ERROR("LibrarySnapshot: Failed to create {}: {}", temporaryPath, std::strerror(error));
+        return false;
+    }
+
+    bool success = (std::fwrite(&header, sizeof(header_t), 1, file) == 1) &&
+                   (std::fwrite(records_.data(), 1, records_.size(), file) == records_.size()) &&
+                   (std::fwrite(strings_.data(), 1, strings_.size(), file) == strings_.size());
+    success = (std::fclose(file) == 0) && success;
+
+    if (success)
+    {
+        success = (std::rename(temporaryPath.c_str(), path.c_str()) == 0);
+    }
+
+    if (!success)
+    {
+        auto error = errno;
+        LOG_ERROR("LibrarySnapshot: Failed to write {}: {}", path, std::strerror(error));
+        std::remove(temporaryPath.c_str());
+    }
+
+    return success;
+}
+
+LibrarySnapshot::LibrarySnapshot(const std::string &path,
+                                 Kind kind,
+                                 std::uint32_t recordSize) noexcept
+{
+#ifndef PLATFORM_WINDOWS
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        auto error = errno;
+        if (error != ENOENT)
+        {
+            LOG_ERROR("LibrarySnapshot: Failed to open {}: {}", path, std::strerror(error));
+        }
+        return;
+    }
+
+    struct stat stbuf;
+    if (fstat(fd, &stbuf) != 0 || static_cast<std::size_t>(stbuf.st_size) < sizeof(header_t))
+    {
+        LOG_WARN("LibrarySnapshot: Ignoring truncated snapshot {}", path);
+        close(fd);
+        return;
+    }
+
+    size_ = static_cast<std::size_t>(stbuf.st_size);
+    auto mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        auto error = errno;
+        LOG_ERROR("LibrarySnapshot: Failed to map {}: {}", path, std::strerror(error));
+        size_ = 0;
+        return;
+    }
+
+    data_ = static_cast<const char *>(mapping);
+
+    auto header = reinterpret_cast<const header_t *>(data_);
+    const auto recordsEnd =
+        sizeof(header_t) + static_cast<std::uint64_t>(header->recordCount) * header->recordSize;
+
+    if (header->magic != MAGIC || header->version != VERSION ||
+        header->kind != static_cast<std::uint16_t>(kind) ||
+        (header->recordCount > 0 && header->recordSize != recordSize) ||
+        header->stringTableOffset != recordsEnd ||
+        header->stringTableOffset + header->stringTableSize > size_)
+    {
+        LOG_WARN("LibrarySnapshot: Ignoring incompatible or corrupt snapshot {}", path);
+        return;
+    }
+
+    header_ = header;
+#else
+    (void)path;
+    (void)kind;
+    (void)recordSize;
+#endif
+}
+
+LibrarySnapshot::~LibrarySnapshot() noexcept
+{
+#ifndef PLATFORM_WINDOWS
+    if (data_ != nullptr)
+    {
+        munmap(const_cast<char *>(data_), size_);
+    }
+#endif
+}
+
+std::string LibrarySnapshot::string(const string_ref_t &ref) const noexcept
+{
+    if (header_ == nullptr ||
+        static_cast<std::uint64_t>(ref.offset) + ref.length > header_->stringTableSize)
+    {
+        return {};
+    }
+
+    return { data_ + header_->stringTableOffset + ref.offset, ref.length };
+}
@@ -1,3 +1,642 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
 #include "libspring_logger.h"
 
-thread_local fmt::MemoryWriter output{};
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace spring;
+using namespace spring::logger;
+
+namespace
+{
+    using Value = fmt::internal::Value;
+    using Arg = fmt::internal::Arg;
+
+    constexpr std::size_t RING_CAPACITY{ 64 * 1024 };
+    /* Anything bigger is written synchronously rather than hogging the ring */
+    constexpr std::size_t MAX_RECORD_SIZE{ RING_CAPACITY / 4 };
+    constexpr std::size_t OUTPUT_CHUNK_SIZE{ 16 * 1024 };
+    constexpr auto IDLE_INTERVAL = std::chrono::milliseconds{ 20 };
+    constexpr std::uint8_t PADDING{ 0xff };
+
+    /* A record is this header, followed by the argument values, their types, the format */
+    /* string and then the contents of all string arguments, in order. Strings are copied */
+    /* since whatever they point to is long gone by the time the record gets formatted.   */
+    struct record_header_t
+    {
+        /* Size of the whole record, rounded up to a multiple of 8 */
+        std::uint32_t size;
+        /* Level of the message, or PADDING for the filler at the end of the ring */
+        std::uint8_t level;
+        std::uint8_t argumentCount;
+        std::uint16_t reserved;
+        std::uint32_t formatSize;
+        std::int32_t line;
+        std::uint64_t sequence;
+        const CallSite *site;
+        const char *function;
+    };
+
+    /* Single producer, single consumer ring: the owning thread writes at the head, the */
+    /* background thread reads at the tail                                              */
+    struct Ring
+    {
+        std::unique_ptr<char[]> data{ new char[RING_CAPACITY] };
+        std::atomic<std::size_t> head{ 0 };
+        std::atomic<std::size_t> tail{ 0 };
+        /* Set when the owning thread exits, the ring is freed once it's drained */
+        std::atomic_bool orphaned{ false };
+    };
+
+    /* Trivially destructible, so it can still be checked after ringHandle is gone */
+    thread_local bool ringHandleDestroyed{ false };
+
+    struct RingHandle
+    {
+        ~RingHandle() noexcept
+        {
+            if (ring != nullptr)
+            {
+                ring->orphaned = true;
+            }
+            ringHandleDestroyed = true;
+        }
+
+        std::shared_ptr<Ring> ring{};
+    };
+
+    struct Backend
+    {
+        std::mutex ringsMutex{};
+        std::vector<std::shared_ptr<Ring>> rings{};
+
+        std::mutex drainMutex{};
+        fmt::MemoryWriter output{};
+
+        std::mutex wakeMutex{};
+        std::condition_variable wake{};
+        std::atomic_bool sleeping{ false };
+
+        std::atomic_bool running{ true };
+        std::atomic<std::uint64_t> sequence{ 0 };
+        std::thread thread{};
+    };
+
+    struct Levels
+    {
+        std::mutex mutex{};
+        std::unordered_map<std::string, Level> modules{};
+        /* Everything that was compiled in gets logged unless configured otherwise */
+        Level fallback{ Level::Debug };
+    };
+
+    thread_local RingHandle ringHandle{};
+
+    inline std::size_t alignedSize(std::size_t size) noexcept
+    {
+        return (size + 7) & ~std::size_t{ 7 };
+    }
+
+    const char *label(std::uint8_t level) noexcept
+    {
+        switch (static_cast<Level>(level))
+        {
+            case Level::Debug:
+                return "  DEBUG";
+            case Level::Info:
+                return "   INFO";
+            case Level::Warning:
+                return "WARNING";
+            case Level::Error:
+                return "  ERROR";
+            default:
+                return "  FATAL";
+        }
+    }
+
+    bool parseLevel(const std::string &name, Level &level) noexcept
+    {
+        static const std::pair<const char *, Level> names[]{
+            { "debug", Level::Debug }, { "info", Level::Info },   { "warning", Level::Warning },
+            { "warn", Level::Warning }, { "error", Level::Error }, { "fatal", Level::Fatal },
+            { "off", Level::Off }
+        };
+
+        for (const auto &it : names)
+        {
+            if (name == it.first)
+            {
+                level = it.second;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    Levels &levels() noexcept
+    {
+        static Levels *instance = [] {
+            auto result = new Levels;
+
+            /* e.g. LIBSPRING_LOG="*=warning,libspring_http_client=debug" */
+            auto LIBSPRING_LOG = std::getenv("LIBSPRING_LOG");
+            if (LIBSPRING_LOG != nullptr)
+            {
+                std::string settings{ LIBSPRING_LOG };
+                std::size_t start{ 0 };
+                while (start < settings.size())
+                {
+                    auto end = settings.find(',', start);
+                    if (end == std::string::npos)
+                    {
+                        end = settings.size();
+                    }
+
+                    const auto entry = settings.substr(start, end - start);
+                    const auto separator = entry.find('=');
+
+                    Level level;
+                    if (separator != std::string::npos &&
+                        parseLevel(entry.substr(separator + 1), level))
+                    {
+                        const auto module = entry.substr(0, separator);
+                        if (module == "*")
+                        {
+                            result->fallback = level;
+                        }
+                        else
+                        {
+                            result->modules[module] = level;
+                        }
+                    }
+                    else
+                    {
+                        std::fprintf(stderr, "WARNING: Ignoring invalid log level setting \"%s\"\n",
+                                     entry.c_str());
+                    }
+
+                    start = end + 1;
+                }
+            }
+
+            return result;
+        }();
+
+        return *instance;
+    }
+
+    void formatMessage(fmt::MemoryWriter &output,
+                       std::uint8_t level,
+                       const CallSite &site,
+                       int line,
+                       const char *function,
+                       fmt::CStringRef format,
+                       const Value *values,
+                       const std::uint8_t *types,
+                       std::size_t count) noexcept
+    {
+        Value packed[fmt::ArgList::MAX_PACKED_ARGS]{};
+        fmt::ULongLong packedTypes{ 0 };
+        for (std::size_t it = 0; it < count; ++it)
+        {
+            packed[it] = values[it];
+            packedTypes |= static_cast<fmt::ULongLong>(types[it]) << (it * 4);
+        }
+
+        output.write("{}: {:<20}: {:<4} ** {:<20} **: ", label(level), site.file(), line, function);
+        output.write(format, fmt::ArgList{ packedTypes, packed });
+        output.write("\n");
+    }
+
+    /* Strings, and custom types formatted up front, end up as plain (pointer, size) strings */
+    inline bool isString(const internal::argument_t &argument) noexcept
+    {
+        return argument.arg.type == Arg::CSTRING || argument.arg.type == Arg::STRING ||
+               argument.arg.type == Arg::CUSTOM;
+    }
+
+    inline fmt::StringRef stringOf(const internal::argument_t &argument) noexcept
+    {
+        switch (argument.arg.type)
+        {
+            case Arg::CSTRING:
+                return argument.arg.string.value != nullptr ? argument.arg.string.value : "(null)";
+            case Arg::STRING:
+                return { argument.arg.string.value, argument.arg.string.size };
+            default:
+                return argument.formatted;
+        }
+    }
+
+    void writeSynchronously(const CallSite &site,
+                            Level level,
+                            int line,
+                            const char *function,
+                            fmt::CStringRef format,
+                            const internal::argument_t *arguments,
+                            std::size_t count) noexcept
+    {
+        Value values[fmt::ArgList::MAX_PACKED_ARGS]{};
+        std::uint8_t types[fmt::ArgList::MAX_PACKED_ARGS]{};
+        for (std::size_t it = 0; it < count; ++it)
+        {
+            if (isString(arguments[it]))
+            {
+                const auto string = stringOf(arguments[it]);
+                values[it].string.value = string.data();
+                values[it].string.size = string.size();
+                types[it] = Arg::STRING;
+            }
+            else
+            {
+                values[it] = arguments[it].arg;
+                types[it] = static_cast<std::uint8_t>(arguments[it].arg.type);
+            }
+        }
+
+        fmt::MemoryWriter output;
+        formatMessage(output, static_cast<std::uint8_t>(level), site, line, function, format,
+                      values, types, count);
+        std::fwrite(output.data(), 1, output.size(), stderr);
+    }
+
+    /* Formats the oldest record across all rings, returns false if they are all empty */
+    bool formatNext(Backend &backend, const std::vector<std::shared_ptr<Ring>> &rings) noexcept
+    {
+        Ring *oldest{ nullptr };
+        const record_header_t *oldestRecord{ nullptr };
+
+        for (const auto &ring : rings)
+        {
+            auto tail = ring->tail.load(std::memory_order_relaxed);
+            const auto head = ring->head.load(std::memory_order_acquire);
+
+            while (tail != head)
+            {
+                auto record = reinterpret_cast<const record_header_t *>(
+                    ring->data.get() + (tail & (RING_CAPACITY - 1)));
+                if (record->level != PADDING)
+                {
+                    if (oldestRecord == nullptr || record->sequence < oldestRecord->sequence)
+                    {
+                        oldest = ring.get();
+                        oldestRecord = record;
+                    }
+                    break;
+                }
+
+                tail += record->size;
+                ring->tail.store(tail, std::memory_order_release);
+            }
+        }
+
+        if (oldest == nullptr)
+        {
+            return false;
+        }
+
+        const auto count = oldestRecord->argumentCount;
+        auto cursor = reinterpret_cast<const char *>(oldestRecord) + sizeof(record_header_t);
+
+        Value values[fmt::ArgList::MAX_PACKED_ARGS]{};
+        std::memcpy(values, cursor, count * sizeof(Value));
+        cursor += count * sizeof(Value);
+
+        const auto types = reinterpret_cast<const std::uint8_t *>(cursor);
+        cursor += count;
+
+        const auto format = cursor;
+        cursor += oldestRecord->formatSize + 1;
+
+        for (std::size_t it = 0; it < count; ++it)
+        {
+            if (types[it] == Arg::STRING)
+            {
+                values[it].string.value = cursor;
+                cursor += values[it].string.size;
+            }
+        }
+
+        formatMessage(backend.output, oldestRecord->level, *oldestRecord->site, oldestRecord->line,
+                      oldestRecord->function, format, values, types, count);
+
+        oldest->tail.fetch_add(oldestRecord->size, std::memory_order_release);
+
+        return true;
+    }
+
+    void writeOutput(Backend &backend) noexcept
+    {
+        if (backend.output.size() > 0)
+        {
+            std::fwrite(backend.output.data(), 1, backend.output.size(), stderr);
+            backend.output.clear();
+        }
+    }
+
+    void drain(Backend &backend) noexcept
+    {
+        std::lock_guard<std::mutex> drainLock{ backend.drainMutex };
+
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock{ backend.ringsMutex };
+            rings = backend.rings;
+        }
+
+        while (formatNext(backend, rings))
+        {
+            if (backend.output.size() >= OUTPUT_CHUNK_SIZE)
+            {
+                writeOutput(backend);
+            }
+        }
+
+        writeOutput(backend);
+
+        std::lock_guard<std::mutex> lock{ backend.ringsMutex };
+        backend.rings.erase(std::remove_if(backend.rings.begin(), backend.rings.end(),
+                                           [](const std::shared_ptr<Ring> &ring) {
+                                               return ring->orphaned &&
+                                                      ring->head == ring->tail;
+                                           }),
+                            backend.rings.end());
+    }
+
+    void process(Backend *backend) noexcept
+    {
+        while (backend->running)
+        {
+            drain(*backend);
+
+            std::unique_lock<std::mutex> lock{ backend->wakeMutex };
+            backend->sleeping = true;
+            backend->wake.wait_for(lock, IDLE_INTERVAL);
+            backend->sleeping = false;
+        }
+    }
+
+    Backend *backendInstance() noexcept;
+
+    void shutdown() noexcept
+    {
+        auto backend = backendInstance();
+
+        backend->running = false;
+        backend->wake.notify_one();
+        if (backend->thread.joinable())
+        {
+            backend->thread.join();
+        }
+
+        drain(*backend);
+    }
+
+    /* Never destroyed, threads may still log while static objects are being torn down */
+    Backend *backendInstance() noexcept
+    {
+        static Backend *instance = [] {
+            auto result = new Backend;
+            result->thread = std::thread{ &process, result };
+            std::atexit(&shutdown);
+            return result;
+        }();
+
+        return instance;
+    }
+
+    Ring *threadRing(Backend &backend) noexcept
+    {
+        if (ringHandleDestroyed)
+        {
+            return nullptr;
+        }
+
+        if (ringHandle.ring == nullptr)
+        {
+            ringHandle.ring = std::make_shared<Ring>();
+
+            std::lock_guard<std::mutex> lock{ backend.ringsMutex };
+            backend.rings.push_back(ringHandle.ring);
+        }
+
+        return ringHandle.ring.get();
+    }
+} // namespace
+
+std::atomic<std::uint32_t> CallSite::levelsGeneration_{ 1 };
+
+CallSite::CallSite(const char *path) noexcept
+  : file_{ std::strrchr(path, PATH_SEPARATOR) != nullptr ? std::strrchr(path, PATH_SEPARATOR) + 1
+                                                         : path }
+{
+}
+
+void CallSite::update() const noexcept
+{
+    const auto generation = levelsGeneration_.load(std::memory_order_acquire);
+
+    std::string module{ file_ };
+    const auto extension = module.rfind('.');
+    if (extension != std::string::npos)
+    {
+        module.erase(extension);
+    }
+
+    level_.store(logger::level(module.c_str()), std::memory_order_relaxed);
+    generation_.store(generation, std::memory_order_relaxed);
+}
+
+void logger::setLevel(const char *module, Level level) noexcept
+{
+    auto &settings = levels();
+
+    {
+        std::lock_guard<std::mutex> lock{ settings.mutex };
+
+        if (std::strcmp(module, "*") == 0)
+        {
+            settings.fallback = level;
+        }
+        else
+        {
+            settings.modules[module] = level;
+        }
+    }
+
+    ++CallSite::levelsGeneration_;
+}
+
+Level logger::level(const char *module) noexcept
+{
+    auto &settings = levels();
+
+    std::lock_guard<std::mutex> lock{ settings.mutex };
+
+    auto it = settings.modules.find(module);
+    return it != settings.modules.end() ? it->second : settings.fallback;
+}
+
+void logger::flush() noexcept
+{
+    drain(*backendInstance());
+}
+
+void logger::internal::enqueue(const CallSite &site,
+                               Level level,
+                               int line,
+                               const char *function,
+                               fmt::CStringRef format,
+                               const argument_t *arguments,
+                               std::size_t count) noexcept
+{
+    auto backend = backendInstance();
+
+    if (level == Level::Fatal)
+    {
+        flush();
+        writeSynchronously(site, level, line, function, format, arguments, count);
+        return;
+    }
+
+    auto ring = backend->running ? threadRing(*backend) : nullptr;
+    if (ring == nullptr)
+    {
+        writeSynchronously(site, level, line, function, format, arguments, count);
+        return;
+    }
+
+    const auto formatSize = std::strlen(format.c_str());
+
+    std::size_t size{ sizeof(record_header_t) + count * (sizeof(Value) + 1) + formatSize + 1 };
+    for (std::size_t it = 0; it < count; ++it)
+    {
+        if (isString(arguments[it]))
+        {
+            size += stringOf(arguments[it]).size();
+        }
+    }
+    size = alignedSize(size);
+
+    if (size > MAX_RECORD_SIZE)
+    {
+        flush();
+        writeSynchronously(site, level, line, function, format, arguments, count);
+        return;
+    }
+
+    auto head = ring->head.load(std::memory_order_relaxed);
+    auto tail = ring->tail.load(std::memory_order_acquire);
+
+    /* Records are never split, if one doesn't fit at the end the rest is skipped */
+    auto offset = head & (RING_CAPACITY - 1);
+    const auto contiguous = RING_CAPACITY - offset;
+    const auto needed = contiguous < size ? contiguous + size : size;
+
+    /* Only happens on bursts, wait for the background thread rather than lose messages */
+    while (RING_CAPACITY - (head - tail) < needed)
+    {
+        if (!backend->running)
+        {
+            writeSynchronously(site, level, line, function, format, arguments, count);
+            return;
+        }
+
+        backend->wake.notify_one();
+        std::this_thread::yield();
+        tail = ring->tail.load(std::memory_order_acquire);
+    }
+
+    if (contiguous < size)
+    {
+        auto padding = reinterpret_cast<record_header_t *>(ring->data.get() + offset);
+        padding->size = static_cast<std::uint32_t>(contiguous);
+        padding->level = PADDING;
+        head += contiguous;
+        offset = 0;
+    }
+
+    auto record = reinterpret_cast<record_header_t *>(ring->data.get() + offset);
+    record->size = static_cast<std::uint32_t>(size);
+    record->level = static_cast<std::uint8_t>(level);
+    record->argumentCount = static_cast<std::uint8_t>(count);
+    record->formatSize = static_cast<std::uint32_t>(formatSize);
+    record->line = line;
+    record->sequence = backend->sequence++;
+    record->site = &site;
+    record->function = function;
+
+    /* Values may not be aligned to what Value requires, hence the memcpy below */
+    auto cursor = reinterpret_cast<char *>(record) + sizeof(record_header_t);
+    auto values = cursor;
+    auto types = reinterpret_cast<std::uint8_t *>(cursor + count * sizeof(Value));
+    cursor += count * (sizeof(Value) + 1);
+
+    std::memcpy(cursor, format.c_str(), formatSize + 1);
+    cursor += formatSize + 1;
+
+    for (std::size_t it = 0; it < count; ++it)
+    {
+        if (isString(arguments[it]))
+        {
+            const auto string = stringOf(arguments[it]);
+            std::memcpy(cursor, string.data(), string.size());
+            cursor += string.size();
+
+            Value value{};
+            value.string.value = nullptr;
+            value.string.size = string.size();
+            std::memcpy(values + it * sizeof(Value), &value, sizeof(Value));
+            types[it] = Arg::STRING;
+        }
+        else
+        {
+            const Value &value = arguments[it].arg;
+            std::memcpy(values + it * sizeof(Value), &value, sizeof(Value));
+            types[it] = static_cast<std::uint8_t>(arguments[it].arg.type);
+        }
+    }
+
+    ring->head.store(head + size, std::memory_order_release);
+
+    /* The background thread wakes up on its own every IDLE_INTERVAL, only hurry it up */
+    /* when the ring starts filling up                                                 */
+    if (head + size - tail > RING_CAPACITY / 2 &&
+        backend->sleeping.load(std::memory_order_relaxed))
+    {
+        backend->wake.notify_one();
+    }
+}
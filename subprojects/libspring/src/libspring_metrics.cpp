@@ -0,0 +1,670 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
+#include "libspring_metrics.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "libspring_logger.h"
+
+using namespace spring;
+using namespace spring::metrics;
+
+namespace
+{
+    /* Requests are only read to find their end, anything past this is ignored */
+    constexpr std::size_t MAX_REQUEST_SIZE{ 4096 };
+    constexpr int CLIENT_TIMEOUT_MS{ 1000 };
+
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Metric
+    {
+        std::string labels;
+        std::unique_ptr<Counter> counter{};
+        std::unique_ptr<Gauge> gauge{};
+        std::unique_ptr<Histogram> histogram{};
+    };
+
+    struct Family
+    {
+        std::string help;
+        Type type;
+        std::vector<std::unique_ptr<Metric>> metrics{};
+    };
+
+    struct Registry
+    {
+        std::mutex mutex{};
+        /* Ordered, so the exposition output is stable between scrapes */
+        std::map<std::string, Family> families{};
+    };
+
+    /* Never destroyed, metrics are referenced from statics all over the place */
+    Registry &registry() noexcept
+    {
+        static auto instance = new Registry;
+        return *instance;
+    }
+
+    struct Paths
+    {
+        /* Removed when the exporter stops, if it listened on a Unix socket */
+        std::string unixSocket{};
+        /* Where the metrics are written at exit, from LIBSPRING_METRICS_DUMP */
+        std::string dump{};
+    };
+
+    /* Function-local, the first metric can be registered while other files' statics are */
+    /* being initialized, before this file's own globals are                             */
+    Paths &paths() noexcept
+    {
+        static Paths instance{};
+        return instance;
+    }
+
+    Metric &findOrAdd(const std::string &name,
+                      const std::string &help,
+                      Type type,
+                      const std::string &labels) noexcept
+    {
+        auto &families = registry().families;
+
+        auto family = families.find(name);
+        if (family == families.end())
+        {
+            family = families.emplace(name, Family{ help, type }).first;
+        }
+        else if (family->second.type != type)
+        {
+            LOG_ERROR("Metrics: {} was already registered with a different type", name);
+        }
+
+        for (auto &metric : family->second.metrics)
+        {
+            if (metric->labels == labels)
+            {
+                return *metric;
+            }
+        }
+
+        family->second.metrics.emplace_back(new Metric{ labels });
+        return *family->second.metrics.back();
+    }
+
+    std::string withLabels(const std::string &labels, const std::string &extra = {}) noexcept
+    {
+        if (labels.empty() && extra.empty())
+        {
+            return {};
+        }
+
+        if (labels.empty() || extra.empty())
+        {
+            return fmt::format("{{{}}}", labels.empty() ? extra : labels);
+        }
+
+        return fmt::format("{{{},{}}}", labels, extra);
+    }
+
+    void renderHistogram(fmt::MemoryWriter &output,
+                         const std::string &name,
+                         const std::string &labels,
+                         const Histogram &histogram) noexcept
+    {
+        const auto &bounds = histogram.bounds();
+        const auto buckets = histogram.buckets();
+
+        std::uint64_t cumulative{ 0 };
+        for (std::size_t it = 0; it < bounds.size(); ++it)
+        {
+            cumulative += buckets[it];
+            output.write("{}_bucket{} {}\n", name,
+                         withLabels(labels, fmt::format("le=\"{}\"", bounds[it])), cumulative);
+        }
+        cumulative += buckets.back();
+        output.write("{}_bucket{} {}\n", name, withLabels(labels, "le=\"+Inf\""), cumulative);
+        output.write("{}_sum{} {}\n", name, withLabels(labels), histogram.sum());
+        output.write("{}_count{} {}\n", name, withLabels(labels), cumulative);
+    }
+
+#ifndef PLATFORM_WINDOWS
+    /* Linux has MSG_NOSIGNAL, the BSDs and macOS set SO_NOSIGPIPE on the socket instead */
+#ifdef MSG_NOSIGNAL
+    constexpr int SEND_FLAGS{ MSG_NOSIGNAL };
+#else
+    constexpr int SEND_FLAGS{ 0 };
+#endif
+
+    /* pipe2(), accept4() and SOCK_CLOEXEC are Linux only */
+    bool setCloseOnExec(int fd) noexcept
+    {
+        const auto flags = fcntl(fd, F_GETFD);
+        return flags >= 0 && fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == 0;
+    }
+
+    class Exporter
+    {
+    public:
+        Exporter(int listenFd) noexcept
+          : listenFd_{ listenFd }
+        {
+            if (pipe(wakeFds_) != 0 || !setCloseOnExec(wakeFds_[0]) ||
+                !setCloseOnExec(wakeFds_[1]))
+            {
+                LOG_ERROR("Metrics: Failed to create wake-up pipe: {}", std::strerror(errno));
+                wakeFds_[0] = wakeFds_[1] = -1;
+            }
+
+            thread_ = std::thread{ &Exporter::run, this };
+        }
+
+        ~Exporter() noexcept
+        {
+            if (wakeFds_[1] >= 0)
+            {
+                const char stop{ 0 };
+                ::write(wakeFds_[1], &stop, 1);
+            }
+
+            thread_.join();
+
+            close(listenFd_);
+            close(wakeFds_[0]);
+            close(wakeFds_[1]);
+        }
+
+    private:
+        void run() noexcept
+        {
+            pollfd fds[2]{ { listenFd_, POLLIN, 0 }, { wakeFds_[0], POLLIN, 0 } };
+
+            for (;;)
+            {
+                if (poll(fds, wakeFds_[0] >= 0 ? 2 : 1, -1) < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    LOG_ERROR("Metrics: Endpoint stopped: {}", std::strerror(errno));
+                    return;
+                }
+
+                if (fds[1].revents != 0)
+                {
+                    return;
+                }
+
+                if (fds[0].revents & POLLIN)
+                {
+                    auto client = accept(listenFd_, nullptr, nullptr);
+                    if (client >= 0)
+                    {
+                        /* Best effort, the socket is closed again right after serving */
+                        setCloseOnExec(client);
+#ifdef SO_NOSIGPIPE
+                        int noSigPipe{ 1 };
+                        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe,
+                                   sizeof(noSigPipe));
+#endif
+                        serve(client);
+                        close(client);
+                    }
+                }
+            }
+        }
+
+        /* Scrapes are rare and tiny, one client at a time is plenty */
+        static void serve(int client) noexcept
+        {
+            char request[MAX_REQUEST_SIZE];
+            std::size_t received{ 0 };
+
+            pollfd fd{ client, POLLIN, 0 };
+            while (received < sizeof(request) && poll(&fd, 1, CLIENT_TIMEOUT_MS) > 0)
+            {
+                auto count = recv(client, request + received, sizeof(request) - received, 0);
+                if (count <= 0)
+                {
+                    break;
+                }
+
+                received += static_cast<std::size_t>(count);
+
+                const std::string headers{ request, received };
+                if (headers.find("\r\n\r\n") != std::string::npos ||
+                    headers.find("\n\n") != std::string::npos)
+                {
+                    break;
+                }
+            }
+
+            const auto body = render();
+            const auto response =
+                fmt::format("HTTP/1.0 200 OK\r\n"
+                            "Content-Type: text/plain; version=0.0.4\r\n"
+                            "Content-Length: {}\r\n"
+                            "Connection: close\r\n\r\n{}",
+                            body.size(), body);
+
+            std::size_t sent{ 0 };
+            while (sent < response.size())
+            {
+                auto count =
+                    send(client, response.data() + sent, response.size() - sent, SEND_FLAGS);
+                if (count <= 0)
+                {
+                    break;
+                }
+                sent += static_cast<std::size_t>(count);
+            }
+        }
+
+    private:
+        int listenFd_;
+        int wakeFds_[2]{ -1, -1 };
+        std::thread thread_{};
+    };
+
+    int listenOnUnixSocket(const char *path) noexcept
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (std::strlen(path) >= sizeof(address.sun_path))
+        {
+            LOG_ERROR("Metrics: Socket path {} is too long", path);
+            return -1;
+        }
+        std::strcpy(address.sun_path, path);
+
+        auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || !setCloseOnExec(fd))
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            return -1;
+        }
+
+        /* Left behind by a previous run that didn't exit cleanly */
+        unlink(path);
+
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    int listenOnLocalhost(int port) noexcept
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        auto fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || !setCloseOnExec(fd))
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            return -1;
+        }
+
+        int reuse{ 1 };
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    Exporter *exporter{ nullptr };
+
+    void stopExporter() noexcept
+    {
+        delete exporter;
+        exporter = nullptr;
+
+        if (!paths().unixSocket.empty())
+        {
+            unlink(paths().unixSocket.c_str());
+        }
+    }
+
+    bool startExporter(const char *endpoint) noexcept
+    {
+        int fd{ -1 };
+        if (std::strncmp(endpoint, "unix:", 5) == 0)
+        {
+            fd = listenOnUnixSocket(endpoint + 5);
+            if (fd >= 0)
+            {
+                paths().unixSocket = endpoint + 5;
+            }
+        }
+        else
+        {
+            char *end{ nullptr };
+            const auto port = std::strtol(endpoint, &end, 10);
+            if (*end != '\0' || port <= 0 || port > 65535)
+            {
+                LOG_ERROR("Metrics: Invalid endpoint {}, expected unix:<path> or a port", endpoint);
+                return false;
+            }
+
+            fd = listenOnLocalhost(static_cast<int>(port));
+        }
+
+        if (fd < 0 || listen(fd, 4) != 0)
+        {
+            LOG_ERROR("Metrics: Failed to listen on {}: {}", endpoint, std::strerror(errno));
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            return false;
+        }
+
+        LOG_INFO("Metrics: Serving metrics on {}", endpoint);
+        exporter = new Exporter{ fd };
+
+        return true;
+    }
+#else
+    void stopExporter() noexcept {}
+
+    bool startExporter(const char *endpoint) noexcept
+    {
+        LOG_WARN("Metrics: Serving metrics on {} is not supported on Windows, use "
+                 "LIBSPRING_METRICS_DUMP instead",
+                 endpoint);
+        return false;
+    }
+#endif
+
+    void finish() noexcept
+    {
+        stopExporter();
+
+        if (!paths().dump.empty())
+        {
+            dump(paths().dump);
+        }
+    }
+
+    bool initialize() noexcept
+    {
+        bool serving{ false };
+
+        auto LIBSPRING_METRICS_ENDPOINT = std::getenv("LIBSPRING_METRICS_ENDPOINT");
+        if (LIBSPRING_METRICS_ENDPOINT != nullptr && LIBSPRING_METRICS_ENDPOINT[0] != '\0')
+        {
+            serving = startExporter(LIBSPRING_METRICS_ENDPOINT);
+        }
+
+        auto LIBSPRING_METRICS_DUMP = std::getenv("LIBSPRING_METRICS_DUMP");
+        if (LIBSPRING_METRICS_DUMP != nullptr && LIBSPRING_METRICS_DUMP[0] != '\0')
+        {
+            paths().dump = LIBSPRING_METRICS_DUMP;
+        }
+
+        if (serving || !paths().dump.empty())
+        {
+            std::atexit(&finish);
+        }
+
+        return true;
+    }
+
+    /* Done when the first metric is registered rather than during static initialization, */
+    /* so merely linking the library doesn't bind a socket or start a thread              */
+    void ensureInitialized() noexcept
+    {
+        static const bool initialized{ initialize() };
+        static_cast<void>(initialized);
+    }
+
+    double fromBits(std::uint64_t bits) noexcept
+    {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::uint64_t toBits(double value) noexcept
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+} // namespace
+
+Histogram::Histogram(std::vector<double> bounds) noexcept
+  : bounds_{ std::move(bounds) }
+  , buckets_{ new std::atomic<std::uint64_t>[bounds_.size() + 1] }
+  , sum_{ toBits(0.0) }
+{
+    for (std::size_t it = 0; it <= bounds_.size(); ++it)
+    {
+        buckets_[it] = 0;
+    }
+}
+
+void Histogram::observe(double value) noexcept
+{
+    std::size_t bucket{ 0 };
+    while (bucket < bounds_.size() && value > bounds_[bucket])
+    {
+        ++bucket;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    auto sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, toBits(fromBits(sum) + value),
+                                       std::memory_order_relaxed))
+    {
+    }
+}
+
+std::vector<std::uint64_t> Histogram::buckets() const noexcept
+{
+    std::vector<std::uint64_t> result(bounds_.size() + 1);
+    for (std::size_t it = 0; it < result.size(); ++it)
+    {
+        result[it] = buckets_[it].load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+std::uint64_t Histogram::count() const noexcept
+{
+    std::uint64_t result{ 0 };
+    for (auto bucket : buckets())
+    {
+        result += bucket;
+    }
+
+    return result;
+}
+
+double Histogram::sum() const noexcept
+{
+    return fromBits(sum_.load(std::memory_order_relaxed));
+}
+
+std::vector<double> metrics::latencyBuckets() noexcept
+{
+    return { 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30 };
+}
+
+Counter &metrics::counter(const std::string &name,
+                          const std::string &help,
+                          const std::string &labels) noexcept
+{
+    ensureInitialized();
+
+    std::lock_guard<std::mutex> lock{ registry().mutex };
+
+    auto &metric = findOrAdd(name, help, Type::Counter, labels);
+    if (metric.counter == nullptr)
+    {
+        metric.counter.reset(new Counter);
+    }
+
+    return *metric.counter;
+}
+
+Gauge &metrics::gauge(const std::string &name,
+                      const std::string &help,
+                      const std::string &labels) noexcept
+{
+    ensureInitialized();
+
+    std::lock_guard<std::mutex> lock{ registry().mutex };
+
+    auto &metric = findOrAdd(name, help, Type::Gauge, labels);
+    if (metric.gauge == nullptr)
+    {
+        metric.gauge.reset(new Gauge);
+    }
+
+    return *metric.gauge;
+}
+
+Histogram &metrics::histogram(const std::string &name,
+                              const std::string &help,
+                              std::vector<double> bounds,
+                              const std::string &labels) noexcept
+{
+    ensureInitialized();
+
+    std::lock_guard<std::mutex> lock{ registry().mutex };
+
+    auto &metric = findOrAdd(name, help, Type::Histogram, labels);
+    if (metric.histogram == nullptr)
+    {
+        metric.histogram.reset(new Histogram{ std::move(bounds) });
+    }
+
+    return *metric.histogram;
+}
+
+std::string metrics::render() noexcept
+{
+    static const char *TYPE_NAMES[]{ "counter", "gauge", "histogram" };
+
+    fmt::MemoryWriter output;
+
+    std::lock_guard<std::mutex> lock{ registry().mutex };
+    for (const auto &family : registry().families)
+    {
+        const auto &name = family.first;
+        output.write("# HELP {} {}\n", name, family.second.help);
+        output.write("# TYPE {} {}\n", name,
+                     TYPE_NAMES[static_cast<std::size_t>(family.second.type)]);
+
+        for (const auto &metric : family.second.metrics)
+        {
+            if (metric->counter != nullptr)
+            {
+                output.write("{}{} {}\n", name, withLabels(metric->labels),
+                             metric->counter->value());
+            }
+            else if (metric->gauge != nullptr)
+            {
+                output.write("{}{} {}\n", name, withLabels(metric->labels),
+                             metric->gauge->value());
+            }
+            else if (metric->histogram != nullptr)
+            {
+                renderHistogram(output, name, metric->labels, *metric->histogram);
+            }
+        }
+    }
+
+    return output.str();
+}
+
+bool metrics::dump(const std::string &path) noexcept
+{
+    const auto metrics = render();
+
+    /* Written next to the destination first, a half-written dump is worse than an old one */
+    const auto temporaryPath = fmt::format("{}.tmp", path);
+    auto file = std::fopen(temporaryPath.c_str(), "w");
+    if (file == nullptr)
+    {
+        LOG_ERROR("Metrics: Failed to open {}: {}", temporaryPath, std::strerror(errno));
+        return false;
+    }
+
+    const auto written = std::fwrite(metrics.data(), 1, metrics.size(), file);
+    const auto closed = std::fclose(file) == 0;
+    if (written != metrics.size() || !closed ||
+        std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        LOG_ERROR("Metrics: Failed to write {}", path);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -30,6 +30,7 @@
 #include <json_format.h>
 
 #include "libspring_logger.h"
+#include "libspring_trace.h"
 #include "libspring_music_track_p.h"
 #include "libspring_plex_media_server_p.h"
 
@@ -39,9 +40,7 @@ using namespace spring::music;
 AlbumPrivate::AlbumPrivate(RawAlbumMetadata &&metadata,
                            std::weak_ptr<PlexMediaServerPrivate> pms) noexcept
   : key_(std::move(metadata.get_key()))
-  /* This micro-algorithm assumes that each key starts with '/library/metadata'*/
-  /* and has exactly 5 charactes... there should be better ways to do this     */
-  , id_(key_.c_str() + 18, 5)
+  , id_(PlexMediaServerPrivate::ratingKey(key_))
   , title_(std::move(metadata.get_title()))
   , artist_(std::move(metadata.get_parentTitle()))
   , genre_(metadata.get_Genre().size() > 0 ? std::move(metadata.get_Genre().at(0).get_tag()) : "")
@@ -49,12 +48,39 @@ AlbumPrivate::AlbumPrivate(RawAlbumMetadata &&metadata,
   , artworkPath_(std::move(metadata.get_thumb()))
   , pms_(pms)
 {
+    auto server = pms_.lock();
+    if (server != nullptr && !artworkPath_.empty())
+    {
+        server->setAlbumThumbnailPath(PlexMediaServerPrivate::ratingKey(key_), artworkPath_);
+    }
 }
 
 AlbumPrivate::~AlbumPrivate() noexcept = default;
 
-Album::Album(AlbumPrivate *priv) noexcept
-  : priv_(priv)
+void AlbumPrivate::update(AlbumPrivate &&other) noexcept
+{
+    std::lock_guard<std::mutex> lock{ mutex_ };
+
+    title_ = std::move(other.title_);
+    artist_ = std::move(other.artist_);
+    genre_ = std::move(other.genre_);
+
+    if (songCount_ != other.songCount_)
+    {
+        songCount_ = other.songCount_;
+        tracksLoaded_ = false;
+        tracks_.clear();
+    }
+
+    if (artworkPath_ != other.artworkPath_)
+    {
+        artworkPath_ = std::move(other.artworkPath_);
+        artworkData_.clear();
+    }
+}
+
+Album::Album(std::shared_ptr<AlbumPrivate> priv) noexcept
+  : priv_(std::move(priv))
 {
 }
 
@@ -76,75 +102,140 @@ const std::string &Album::id() const noexcept
     return priv_->id_;
 }
 
-const std::string &Album::title() const noexcept
+std::string Album::title() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->title_;
 }
 
-const std::string &Album::artist() const noexcept
+std::string Album::artist() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->artist_;
 }
 
-const std::string &Album::genre() const noexcept
+std::string Album::genre() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->genre_;
 }
 
 std::size_t Album::songCount() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->songCount_;
 }
 
-const std::string &Album::artwork() const noexcept
+std::string Album::artworkPath() const noexcept
+{
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
+    return priv_->artworkPath_;
+}
+
+std::string Album::artwork() const noexcept
+{
+    std::unique_lock<std::mutex> lock{ priv_->mutex_ };
+
+    if (!priv_->artworkData_.empty())
+    {
+        return priv_->artworkData_;
+    }
+
+    auto artworkPath = priv_->artworkPath_;
+    /* Not held over the request, so the rest of the album stays readable meanwhile */
+    lock.unlock();
+
+    auto pms = priv_->pms_.lock();
+    if (pms == nullptr)
+    {
+        LOG_ERROR("Album: Invalid connection handle. PlexMediaServer "
+                  "instance was deleted!");
+        return {};
+    }
+
+    auto r = pms->sharedRequest(std::string{ artworkPath });
+    if (PlexMediaServerPrivate::requestFailed(r, "album artwork"))
+    {
+        return {};
+    }
+
+    lock.lock();
+    if (priv_->artworkPath_ == artworkPath)
+    {
+        priv_->artworkData_ = r.response.text;
+    }
+
+    return std::move(r.response.text);
+}
+
+std::string Album::artwork(std::uint32_t width, std::uint32_t height) const noexcept
 {
-    if (priv_->artworkData_.empty())
+    auto pms = priv_->pms_.lock();
+    if (pms != nullptr)
     {
-        auto pms = priv_->pms_.lock();
-        if (pms != nullptr)
-        {
-            /* TODO: Error handling */
-            auto r = pms->request(priv_->artworkPath_.c_str());
-            priv_->artworkData_ = std::move(r.response.text);
-        }
-        else
-        {
-            LOG_ERROR("Album: Invalid connection handle. PlexMediaServer "
-                      "instance was deleted!");
-        }
+        return pms->resizedImage(artworkPath(), width, height);
+    }
+    else
+    {
+        LOG_ERROR("Album: Invalid connection handle. PlexMediaServer "
+                  "instance was deleted!");
     }
 
-    return priv_->artworkData_;
+    return {};
 }
 
 std::vector<Track> Album::tracks() const noexcept
 {
     using namespace sequential_formats;
 
-    std::vector<music::TrackPrivate *> result{};
+    std::unique_lock<std::mutex> lock{ priv_->mutex_ };
 
-    auto pms = priv_->pms_.lock();
-    if (pms != nullptr)
+    if (priv_->tracksLoaded_)
     {
-        /* TODO: Error handling */
-        auto r = pms->request(std::string{ priv_->key_ });
-        auto body = std::move(r.response.text);
-
-        JsonFormat format{ body };
-        auto container = sequential::from_format<music::TrackPrivate::LibraryContainer>(format);
-
-        auto &metadata = container.get_MediaContainer().get_Metadata();
-        result.reserve(metadata.size());
-        for (auto &m : metadata)
-        {
-            result.push_back(new music::TrackPrivate{ std::move(m), priv_->pms_ });
-        }
+        return { priv_->tracks_.begin(), priv_->tracks_.end() };
     }
-    else
+
+    /* Not held over the request, so the rest of the album stays readable meanwhile. Two */
+    /* threads may both end up listing the tracks, only the first one is kept.           */
+    lock.unlock();
+
+    auto pms = priv_->pms_.lock();
+    if (pms == nullptr)
     {
         LOG_ERROR("MusicLibrary: Invalid connection handle. PlexMediaServer "
                   "instance was deleted!");
+        return {};
+    }
+
+    /* Not memoized on failure, the album is shared and would stay empty everywhere */
+    auto r = pms->request(std::string{ priv_->key_ });
+    if (PlexMediaServerPrivate::requestFailed(r, "album tracks"))
+    {
+        return {};
+    }
+    auto body = std::move(r.response.text);
+
+    trace::Span parse{ "json", "Parse tracks" };
+    JsonFormat format{ body };
+    auto container = sequential::from_format<music::TrackPrivate::LibraryContainer>(format);
+    parse.end();
+
+    auto &metadata = container.get_MediaContainer().get_Metadata();
+    std::vector<std::shared_ptr<TrackPrivate>> tracks{};
+    tracks.reserve(metadata.size());
+    for (auto &m : metadata)
+    {
+        tracks.push_back(pms->tracks().get(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+            return std::make_shared<music::TrackPrivate>(std::move(m), priv_->pms_);
+        }));
+    }
+
+    lock.lock();
+    if (!priv_->tracksLoaded_)
+    {
+        priv_->tracks_ = std::move(tracks);
+        priv_->tracksLoaded_ = true;
     }
 
-    return { result.begin(), result.end() };
+    return { priv_->tracks_.begin(), priv_->tracks_.end() };
 }
@@ -31,6 +31,7 @@
 
 #include "libspring_library_section_p.h"
 #include "libspring_logger.h"
+#include "libspring_trace.h"
 #include "libspring_music_album_p.h"
 #include "libspring_music_track_p.h"
 #include "libspring_plex_media_server_p.h"
@@ -42,9 +43,7 @@ ArtistPrivate::ArtistPrivate(RawArtistMetadata &&metadata,
                              std::int32_t sectionId,
                              std::weak_ptr<PlexMediaServerPrivate> pms) noexcept
   : key_(std::move(metadata.get_key()))
-  /* This micro-algorithm assumes that each key starts with '/library/metadata'*/
-  /* and has exactly 5 charactes... there should be better ways to do this     */
-  , id_(key_.c_str() + 18, 5)
+  , id_(PlexMediaServerPrivate::ratingKey(key_))
   , name_(std::move(metadata.get_title()))
   , summary_(std::move(metadata.get_summary()))
   , country_(metadata.get_Country().size() > 0 ? std::move(metadata.get_Country().at(0).get_tag()) :
@@ -60,8 +59,24 @@ ArtistPrivate::ArtistPrivate(RawArtistMetadata &&metadata,
 
 ArtistPrivate::~ArtistPrivate() noexcept = default;
 
-Artist::Artist(ArtistPrivate *priv) noexcept
-  : priv_(priv)
+void ArtistPrivate::update(ArtistPrivate &&other) noexcept
+{
+    std::lock_guard<std::mutex> lock{ mutex_ };
+
+    name_ = std::move(other.name_);
+    summary_ = std::move(other.summary_);
+    country_ = std::move(other.country_);
+    genre_ = std::move(other.genre_);
+
+    if (thumbnailPath_ != other.thumbnailPath_)
+    {
+        thumbnailPath_ = std::move(other.thumbnailPath_);
+        artworkData_.clear();
+    }
+}
+
+Artist::Artist(std::shared_ptr<ArtistPrivate> priv) noexcept
+  : priv_(std::move(priv))
 {
 }
 
@@ -83,23 +98,27 @@ const std::string &Artist::id() const noexcept
 
 Artist::~Artist() noexcept = default;
 
-const std::string &Artist::name() const noexcept
+std::string Artist::name() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->name_;
 }
 
-const std::string &Artist::summary() const noexcept
+std::string Artist::summary() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->summary_;
 }
 
-const std::string &Artist::country() const noexcept
+std::string Artist::country() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->country_;
 }
 
-const std::string &Artist::genre() const noexcept
+std::string Artist::genre() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->genre_;
 }
 
@@ -107,39 +126,63 @@ std::vector<Album> Artist::albums() const noexcept
 {
     using namespace sequential_formats;
 
-    std::vector<AlbumPrivate *> result{};
+    std::unique_lock<std::mutex> lock{ priv_->mutex_ };
 
-    auto pms = priv_->pms_.lock();
-    if (pms != nullptr)
+    if (priv_->albumsLoaded_)
     {
-        /* TODO: Error handling */
-        auto r = pms->request(priv_->key_ + "/children");
-        auto body = std::move(r.response.text);
+        return { priv_->albums_.begin(), priv_->albums_.end() };
+    }
 
-        JsonFormat format{ body };
-        auto container = sequential::from_format<AlbumPrivate::LibraryContainer>(format);
+    /* Not held over the request, so the rest of the artist stays readable meanwhile. Two */
+    /* threads may both end up listing the albums, only the first one is kept.            */
+    lock.unlock();
 
-        auto &metadata = container.get_MediaContainer().get_Metadata();
-        result.reserve(metadata.size());
-        for (auto &m : metadata)
-        {
-            result.push_back(new AlbumPrivate{ std::move(m), priv_->pms_ });
-        }
-    }
-    else
+    auto pms = priv_->pms_.lock();
+    if (pms == nullptr)
     {
         LOG_ERROR("Artist: Invalid connection handle. PlexMediaServer "
                   "instance was deleted!");
+        return {};
     }
 
-    return { result.begin(), result.end() };
+    /* Not memoized on failure, the artist is shared and would stay empty everywhere */
+    auto r = pms->request(priv_->key_ + "/children");
+    if (PlexMediaServerPrivate::requestFailed(r, "artist albums"))
+    {
+        return {};
+    }
+    auto body = std::move(r.response.text);
+
+    trace::Span parse{ "json", "Parse albums" };
+    JsonFormat format{ body };
+    auto container = sequential::from_format<AlbumPrivate::LibraryContainer>(format);
+    parse.end();
+
+    auto &metadata = container.get_MediaContainer().get_Metadata();
+    std::vector<std::shared_ptr<AlbumPrivate>> albums{};
+    albums.reserve(metadata.size());
+    for (auto &m : metadata)
+    {
+        albums.push_back(pms->albums().get(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+            return std::make_shared<AlbumPrivate>(std::move(m), priv_->pms_);
+        }));
+    }
+
+    lock.lock();
+    if (!priv_->albumsLoaded_)
+    {
+        priv_->albums_ = std::move(albums);
+        priv_->albumsLoaded_ = true;
+    }
+
+    return { priv_->albums_.begin(), priv_->albums_.end() };
 }
 
 std::vector<Track> Artist::tracks() const noexcept
 {
     using namespace sequential_formats;
 
-    std::vector<TrackPrivate *> result{};
+    std::vector<std::shared_ptr<TrackPrivate>> result{};
 
     auto pms = priv_->pms_.lock();
     if (pms != nullptr)
@@ -148,14 +191,19 @@ std::vector<Track> Artist::tracks() const noexcept
         auto r = pms->request(priv_->key_ + "/allLeaves");
         auto body = std::move(r.response.text);
 
+        trace::Span parse{ "json", "Parse tracks" };
         JsonFormat format{ body };
         auto container = sequential::from_format<TrackPrivate::LibraryContainer>(format);
+        parse.end();
 
         auto &metadata = container.get_MediaContainer().get_Metadata();
         result.reserve(metadata.size());
         for (auto &m : metadata)
         {
-            result.push_back(new TrackPrivate{ std::move(m), priv_->pms_ });
+            result.push_back(
+                pms->tracks().get(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+                    return std::make_shared<TrackPrivate>(std::move(m), priv_->pms_);
+                }));
         }
     }
     else
@@ -171,7 +219,7 @@ std::vector<Track> Artist::popularTracks(std::size_t count) const noexcept
 {
     using namespace sequential_formats;
 
-    std::vector<music::TrackPrivate *> result{};
+    std::vector<std::shared_ptr<TrackPrivate>> result{};
 
     auto pms = priv_->pms_.lock();
     if (pms != nullptr)
@@ -184,14 +232,19 @@ std::vector<Track> Artist::popularTracks(std::size_t count) const noexcept
         auto r = pms->request(std::move(requestString));
         auto body = std::move(r.response.text);
 
+        trace::Span parse{ "json", "Parse tracks" };
         JsonFormat format{ body };
         auto container = sequential::from_format<TrackPrivate::LibraryContainer>(format);
+        parse.end();
 
         auto &metadata = container.get_MediaContainer().get_Metadata();
         result.reserve(metadata.size());
         for (auto &m : metadata)
         {
-            result.push_back(new TrackPrivate{ std::move(m), priv_->pms_ });
+            result.push_back(
+                pms->tracks().get(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+                    return std::make_shared<TrackPrivate>(std::move(m), priv_->pms_);
+                }));
         }
     }
     else
@@ -203,23 +256,60 @@ std::vector<Track> Artist::popularTracks(std::size_t count) const noexcept
     return { result.begin(), result.end() };
 }
 
-const std::string &Artist::artwork() const noexcept
+std::string Artist::artworkPath() const noexcept
+{
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
+    return priv_->thumbnailPath_;
+}
+
+std::string Artist::artwork() const noexcept
 {
-    if (priv_->artworkData_.empty())
+    std::unique_lock<std::mutex> lock{ priv_->mutex_ };
+
+    if (!priv_->artworkData_.empty())
     {
-        auto pms = priv_->pms_.lock();
-        if (pms != nullptr)
-        {
-            /* TODO: Error handling */
-            auto r = pms->request(priv_->thumbnailPath_.c_str());
-            priv_->artworkData_ = std::move(r.response.text);
-        }
-        else
-        {
-            LOG_ERROR("Artist: Invalid connection handle. PlexMediaServer "
-                      "instance was deleted!");
-        }
+        return priv_->artworkData_;
+    }
+
+    auto thumbnailPath = priv_->thumbnailPath_;
+    /* Not held over the request, so the rest of the artist stays readable meanwhile */
+    lock.unlock();
+
+    auto pms = priv_->pms_.lock();
+    if (pms == nullptr)
+    {
+        LOG_ERROR("Artist: Invalid connection handle. PlexMediaServer "
+                  "instance was deleted!");
+        return {};
+    }
+
+    auto r = pms->sharedRequest(std::string{ thumbnailPath });
+    if (PlexMediaServerPrivate::requestFailed(r, "artist artwork"))
+    {
+        return {};
+    }
+
+    lock.lock();
+    if (priv_->thumbnailPath_ == thumbnailPath)
+    {
+        priv_->artworkData_ = r.response.text;
+    }
+
+    return std::move(r.response.text);
+}
+
+std::string Artist::artwork(std::uint32_t width, std::uint32_t height) const noexcept
+{
+    auto pms = priv_->pms_.lock();
+    if (pms != nullptr)
+    {
+        return pms->resizedImage(artworkPath(), width, height);
+    }
+    else
+    {
+        LOG_ERROR("Artist: Invalid connection handle. PlexMediaServer "
+                  "instance was deleted!");
     }
 
-    return priv_->artworkData_;
+    return {};
 }
@@ -27,10 +27,15 @@
 #include "libspring_music_library.h"
 #include "libspring_music_library_p.h"
 
+#include <algorithm>
+#include <cctype>
+
 #include <json_format.h>
 
 #include "libspring_library_section_p.h"
+#include "libspring_library_snapshot_p.h"
 #include "libspring_logger.h"
+#include "libspring_trace.h"
 #include "libspring_music_album_p.h"
 #include "libspring_music_artist_p.h"
 #include "libspring_music_genre_p.h"
@@ -39,6 +44,69 @@
 
 using namespace spring;
 
+namespace
+{
+    using AlbumContainer = music::AlbumPrivate::LibraryContainer::media_container_t;
+    using AlbumMetadata = AlbumContainer::metadata_t;
+    using ArtistContainer = music::ArtistPrivate::LibraryContainer::media_container_t;
+    using ArtistMetadata = ArtistContainer::metadata_t;
+
+    void saveAlbumSnapshot(const std::string &path,
+                           const std::vector<AlbumMetadata> &metadata) noexcept
+    {
+        LibrarySnapshot::Writer writer{ LibrarySnapshot::Kind::Albums };
+
+        for (const auto &m : metadata)
+        {
+            LibrarySnapshot::album_record_t record{};
+            record.key = writer.addString(m.get_key());
+            record.title = writer.addString(m.get_title());
+            record.artist = writer.addString(m.get_parentTitle());
+            record.artistKey = writer.addString(m.get_parentKey());
+            record.thumb = writer.addString(m.get_thumb());
+            record.genre =
+                writer.addString(m.get_Genre().size() > 0 ? m.get_Genre().at(0).get_tag() : "");
+            record.leafCount = m.get_leafCount();
+            writer.addRecord(record);
+        }
+
+        writer.save(path);
+    }
+
+    void saveArtistSnapshot(const std::string &path,
+                            const std::vector<ArtistMetadata> &metadata,
+                            std::int32_t sectionId) noexcept
+    {
+        LibrarySnapshot::Writer writer{ LibrarySnapshot::Kind::Artists };
+
+        for (const auto &m : metadata)
+        {
+            LibrarySnapshot::artist_record_t record{};
+            record.key = writer.addString(m.get_key());
+            record.title = writer.addString(m.get_title());
+            record.summary = writer.addString(m.get_summary());
+            record.thumb = writer.addString(m.get_thumb());
+            record.country = writer.addString(
+                m.get_Country().size() > 0 ? m.get_Country().at(0).get_tag() : "");
+            record.genre =
+                writer.addString(m.get_Genre().size() > 0 ? m.get_Genre().at(0).get_tag() : "");
+            record.librarySectionId = sectionId;
+            writer.addRecord(record);
+        }
+
+        writer.save(path);
+    }
+
+    void addToSummary(MusicLibrary::ArtistSummaries &summaries,
+                      const std::string &artistKey,
+                      std::size_t trackCount) noexcept
+    {
+        auto &summary = summaries[PlexMediaServerPrivate::ratingKey(artistKey)];
+        summary.albumCount += 1;
+        summary.trackCount += trackCount;
+    }
+} // namespace
+
 MusicLibraryPrivate::MusicLibraryPrivate(std::string key,
                                          std::weak_ptr<PlexMediaServerPrivate> pms) noexcept
   : key_(key)
@@ -48,6 +116,21 @@ MusicLibraryPrivate::MusicLibraryPrivate(std::string key,
 
 MusicLibraryPrivate::~MusicLibraryPrivate() noexcept = default;
 
+std::string MusicLibraryPrivate::snapshotPath(const char *listing) const noexcept
+{
+    /* Section keys are only unique on one server */
+    std::string server{};
+    auto pms = pms_.lock();
+    if (pms != nullptr)
+    {
+        server = pms->url();
+        std::replace_if(server.begin(), server.end(),
+                        [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); }, '_');
+    }
+
+    return fmt::format("{}/{}-section-{}-{}.snapshot", snapshotDirectory_, server, key_, listing);
+}
+
 MusicLibrary::MusicLibrary(MusicLibraryPrivate *priv) noexcept
   : priv_(priv)
 {
@@ -66,27 +149,40 @@ MusicLibrary &MusicLibrary::operator=(MusicLibrary &&other) noexcept
     return *this;
 }
 
-std::vector<MusicLibrary::Album> MusicLibrary::albums() const noexcept
+std::vector<MusicLibrary::Album> MusicLibrary::albums(Error *error) const noexcept
 {
     using namespace sequential_formats;
 
-    std::vector<music::AlbumPrivate *> result{};
+    std::vector<std::shared_ptr<music::AlbumPrivate>> result{};
 
     auto pms = priv_->pms_.lock();
     if (pms != nullptr)
     {
-        /* TODO: Error handling */
-        auto r =
-            pms->request(std::string{ LIBRARY_SECTION_REQUEST_PATH "/" } + priv_->key_ + "/albums");
+        auto r = pms->sharedRequest(std::string{ LIBRARY_SECTION_REQUEST_PATH "/" } + priv_->key_ +
+                                    "/albums");
+        if (PlexMediaServerPrivate::requestFailed(r, "albums", error))
+        {
+            return {};
+        }
         auto body = std::move(r.response.text);
 
+        trace::Span parse{ "json", "Parse albums" };
         JsonFormat format{ body };
         auto container = sequential::from_format<music::AlbumPrivate::LibraryContainer>(format);
+        parse.end();
         auto &metadata = container.get_MediaContainer().get_Metadata();
+        if (!priv_->snapshotDirectory_.empty())
+        {
+            saveAlbumSnapshot(priv_->snapshotPath("albums"), metadata);
+        }
+
         result.reserve(metadata.size());
         for (auto &m : metadata)
         {
-            result.push_back(new music::AlbumPrivate{ std::move(m), priv_->pms_ });
+            result.push_back(
+                pms->albums().get(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+                    return std::make_shared<music::AlbumPrivate>(std::move(m), priv_->pms_);
+                }));
         }
     }
     else
@@ -98,28 +194,43 @@ std::vector<MusicLibrary::Album> MusicLibrary::albums() const noexcept
     return { result.begin(), result.end() };
 }
 
-std::vector<MusicLibrary::Artist> MusicLibrary::artists() const noexcept
+std::vector<MusicLibrary::Artist> MusicLibrary::artists(Error *error) const noexcept
 {
     using namespace sequential_formats;
 
-    std::vector<music::ArtistPrivate *> result{};
+    std::vector<std::shared_ptr<music::ArtistPrivate>> result{};
 
     auto pms = priv_->pms_.lock();
     if (pms != nullptr)
     {
-        /* TODO: Error handling */
         auto r =
             pms->request(std::string{ LIBRARY_SECTION_REQUEST_PATH "/" } + priv_->key_ + "/all");
+        if (PlexMediaServerPrivate::requestFailed(r, "artists", error))
+        {
+            return {};
+        }
         auto body = std::move(r.response.text);
 
+        trace::Span parse{ "json", "Parse artists" };
         JsonFormat format{ body };
         auto container = sequential::from_format<music::ArtistPrivate::LibraryContainer>(format);
+        parse.end();
         auto &metadata = container.get_MediaContainer().get_Metadata();
+        if (!priv_->snapshotDirectory_.empty())
+        {
+            saveArtistSnapshot(priv_->snapshotPath("artists"), metadata,
+                               container.get_MediaContainer().get_librarySectionID());
+        }
+
         result.reserve(metadata.size());
+        const auto sectionId = container.get_MediaContainer().get_librarySectionID();
         for (auto &m : metadata)
         {
-            result.push_back(new music::ArtistPrivate{
-                std::move(m), container.get_MediaContainer().get_librarySectionID(), priv_->pms_ });
+            result.push_back(
+                pms->artists().get(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+                    return std::make_shared<music::ArtistPrivate>(std::move(m), sectionId,
+                                                                  priv_->pms_);
+                }));
         }
     }
     else
@@ -131,6 +242,42 @@ std::vector<MusicLibrary::Artist> MusicLibrary::artists() const noexcept
     return { result.begin(), result.end() };
 }
 
+MusicLibrary::ArtistSummaries MusicLibrary::artistSummaries(Error *error) const noexcept
+{
+    using namespace sequential_formats;
+
+    ArtistSummaries result{};
+
+    auto pms = priv_->pms_.lock();
+    if (pms != nullptr)
+    {
+        auto r = pms->sharedRequest(std::string{ LIBRARY_SECTION_REQUEST_PATH "/" } + priv_->key_ +
+                                    "/albums");
+        if (PlexMediaServerPrivate::requestFailed(r, "albums", error))
+        {
+            return result;
+        }
+        auto body = std::move(r.response.text);
+
+        trace::Span parse{ "json", "Parse albums" };
+        JsonFormat format{ body };
+        auto container = sequential::from_format<music::AlbumPrivate::LibraryContainer>(format);
+        parse.end();
+
+        for (const auto &m : container.get_MediaContainer().get_Metadata())
+        {
+            addToSummary(result, m.get_parentKey(), m.get_leafCount());
+        }
+    }
+    else
+    {
+        LOG_ERROR("MusicLibrary: Invalid connection handle. PlexMediaServer "
+                  "instance was deleted!");
+    }
+
+    return result;
+}
+
 std::vector<MusicLibrary::Genre> MusicLibrary::genres() const noexcept
 {
     using namespace sequential_formats;
@@ -145,8 +292,10 @@ std::vector<MusicLibrary::Genre> MusicLibrary::genres() const noexcept
             pms->request(std::string{ LIBRARY_SECTION_REQUEST_PATH "/" } + priv_->key_ + "/genre");
         auto body = std::move(r.response.text);
 
+        trace::Span parse{ "json", "Parse genres" };
         JsonFormat format{ body };
         auto container = sequential::from_format<music::GenrePrivate::LibraryContainer>(format);
+        parse.end();
 
         auto &metadata = container.get_MediaContainer().get_Directory();
         result.reserve(metadata.size());
@@ -168,7 +317,7 @@ std::vector<MusicLibrary::Track> MusicLibrary::tracks() const noexcept
 {
     using namespace sequential_formats;
 
-    std::vector<music::TrackPrivate *> result{};
+    std::vector<std::shared_ptr<music::TrackPrivate>> result{};
 
     auto pms = priv_->pms_.lock();
     if (pms != nullptr)
@@ -178,14 +327,19 @@ std::vector<MusicLibrary::Track> MusicLibrary::tracks() const noexcept
                               "/all?type=10");
         auto body = std::move(r.response.text);
 
+        trace::Span parse{ "json", "Parse tracks" };
         JsonFormat format{ body };
         auto container = sequential::from_format<music::TrackPrivate::LibraryContainer>(format);
+        parse.end();
 
         auto &metadata = container.get_MediaContainer().get_Metadata();
         result.reserve(metadata.size());
         for (auto &m : metadata)
         {
-            result.push_back(new music::TrackPrivate{ std::move(m), priv_->pms_ });
+            result.push_back(
+                pms->tracks().get(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+                    return std::make_shared<music::TrackPrivate>(std::move(m), priv_->pms_);
+                }));
         }
     }
     else
@@ -196,3 +350,111 @@ std::vector<MusicLibrary::Track> MusicLibrary::tracks() const noexcept
 
     return { result.begin(), result.end() };
 }
+
+void MusicLibrary::enableSnapshots(const std::string &directory) noexcept
+{
+    priv_->snapshotDirectory_ = directory;
+}
+
+std::vector<MusicLibrary::Album> MusicLibrary::cachedAlbums() const noexcept
+{
+    std::vector<std::shared_ptr<music::AlbumPrivate>> result{};
+
+    auto pms = priv_->pms_.lock();
+    if (pms != nullptr && !priv_->snapshotDirectory_.empty())
+    {
+        LibrarySnapshot snapshot{ priv_->snapshotPath("albums"), LibrarySnapshot::Kind::Albums,
+                                  sizeof(LibrarySnapshot::album_record_t) };
+
+        result.reserve(snapshot.count());
+        for (std::size_t it = 0; it < snapshot.count(); ++it)
+        {
+            const auto &record = snapshot.record<LibrarySnapshot::album_record_t>(it);
+
+            AlbumMetadata m{};
+            m.set_key(snapshot.string(record.key));
+            m.set_title(snapshot.string(record.title));
+            m.set_parentTitle(snapshot.string(record.artist));
+            m.set_parentKey(snapshot.string(record.artistKey));
+            m.set_thumb(snapshot.string(record.thumb));
+            m.set_leafCount(static_cast<std::size_t>(record.leafCount));
+            if (record.genre.length > 0)
+            {
+                AlbumContainer::genre_t genre{};
+                genre.set_tag(snapshot.string(record.genre));
+                m.get_Genre().push_back(std::move(genre));
+            }
+
+            result.push_back(
+                pms->albums().getCached(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+                    return std::make_shared<music::AlbumPrivate>(std::move(m), priv_->pms_);
+                }));
+        }
+    }
+
+    return { result.begin(), result.end() };
+}
+
+std::vector<MusicLibrary::Artist> MusicLibrary::cachedArtists() const noexcept
+{
+    std::vector<std::shared_ptr<music::ArtistPrivate>> result{};
+
+    auto pms = priv_->pms_.lock();
+    if (pms != nullptr && !priv_->snapshotDirectory_.empty())
+    {
+        LibrarySnapshot snapshot{ priv_->snapshotPath("artists"), LibrarySnapshot::Kind::Artists,
+                                  sizeof(LibrarySnapshot::artist_record_t) };
+
+        result.reserve(snapshot.count());
+        for (std::size_t it = 0; it < snapshot.count(); ++it)
+        {
+            const auto &record = snapshot.record<LibrarySnapshot::artist_record_t>(it);
+
+            ArtistMetadata m{};
+            m.set_key(snapshot.string(record.key));
+            m.set_title(snapshot.string(record.title));
+            m.set_summary(snapshot.string(record.summary));
+            m.set_thumb(snapshot.string(record.thumb));
+            if (record.country.length > 0)
+            {
+                ArtistContainer::country_t country{};
+                country.set_tag(snapshot.string(record.country));
+                m.get_Country().push_back(std::move(country));
+            }
+            if (record.genre.length > 0)
+            {
+                ArtistContainer::genre_t genre{};
+                genre.set_tag(snapshot.string(record.genre));
+                m.get_Genre().push_back(std::move(genre));
+            }
+
+            result.push_back(
+                pms->artists().getCached(PlexMediaServerPrivate::ratingKey(m.get_key()), [&] {
+                    return std::make_shared<music::ArtistPrivate>(
+                        std::move(m), record.librarySectionId, priv_->pms_);
+                }));
+        }
+    }
+
+    return { result.begin(), result.end() };
+}
+
+MusicLibrary::ArtistSummaries MusicLibrary::cachedArtistSummaries() const noexcept
+{
+    ArtistSummaries result{};
+
+    if (!priv_->snapshotDirectory_.empty())
+    {
+        LibrarySnapshot snapshot{ priv_->snapshotPath("albums"), LibrarySnapshot::Kind::Albums,
+                                  sizeof(LibrarySnapshot::album_record_t) };
+
+        for (std::size_t it = 0; it < snapshot.count(); ++it)
+        {
+            const auto &record = snapshot.record<LibrarySnapshot::album_record_t>(it);
+            addToSummary(result, snapshot.string(record.artistKey),
+                         static_cast<std::size_t>(record.leafCount));
+        }
+    }
+
+    return result;
+}
@@ -30,6 +30,7 @@
 #include <json_format.h>
 
 #include "libspring_logger.h"
+#include "libspring_trace.h"
 #include "libspring_music_album_p.h"
 #include "libspring_plex_media_server_p.h"
 
@@ -70,6 +71,26 @@ TrackPrivate::TrackPrivate(RawTrackMetadata &&metadata,
 
 TrackPrivate::~TrackPrivate() noexcept = default;
 
+void TrackPrivate::update(TrackPrivate &&other) noexcept
+{
+    std::lock_guard<std::mutex> lock{ mutex_ };
+
+    key_ = std::move(other.key_);
+    title_ = std::move(other.title_);
+    album_ = std::move(other.album_);
+    album_key_ = std::move(other.album_key_);
+    artist_ = std::move(other.artist_);
+    duration_ = other.duration_;
+    filePath_ = std::move(other.filePath_);
+    fileSize_ = other.fileSize_;
+
+    if (artworkPath_ != other.artworkPath_)
+    {
+        artworkPath_ = std::move(other.artworkPath_);
+        artworkData_.clear();
+    }
+}
+
 std::string TrackPrivate::path(Seconds offset, std::uint32_t bitrate) const noexcept
 {
     auto pms = pms_.lock();
@@ -95,8 +116,42 @@ std::string TrackPrivate::path(Seconds offset, std::uint32_t bitrate) const noex
     return {};
 }
 
-Track::Track(TrackPrivate *priv) noexcept
-  : priv_(priv)
+std::string TrackPrivate::artworkPath(PlexMediaServerPrivate &pms) const noexcept
+{
+    std::unique_lock<std::mutex> lock{ mutex_ };
+    if (!artworkPath_.empty())
+    {
+        return artworkPath_;
+    }
+
+    const auto albumKey = album_key_;
+    lock.unlock();
+
+    const auto albumRatingKey = PlexMediaServerPrivate::ratingKey(albumKey);
+
+    auto result = pms.albumThumbnailPath(albumRatingKey);
+    if (result.empty())
+    {
+        using namespace sequential_formats;
+
+        auto r = pms.sharedRequest(std::string{ albumKey });
+        trace::Span parse{ "json", "Parse albums" };
+        JsonFormat format{ r.response.text };
+        auto mediaContainer = sequential::from_format<music::AlbumPrivate::LibraryContainer>(format);
+        parse.end();
+        auto &metadata = mediaContainer.get_MediaContainer().get_Metadata();
+        if (!metadata.empty())
+        {
+            result = std::move(metadata.at(0).get_thumb());
+            pms.setAlbumThumbnailPath(albumRatingKey, result);
+        }
+    }
+
+    return result;
+}
+
+Track::Track(std::shared_ptr<TrackPrivate> priv) noexcept
+  : priv_(std::move(priv))
 {
 }
 
@@ -114,70 +169,98 @@ Track &Track::operator=(Track &&other) noexcept
     return *this;
 }
 
-const std::string &Track::title() const noexcept
+std::string Track::title() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->title_;
 }
 
-const std::string &Track::album() const noexcept
+std::string Track::album() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->album_;
 }
 
-const std::string &Track::artist() const noexcept
+std::string Track::artist() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->artist_;
 }
 
 Track::Milliseconds Track::duration() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->duration_;
 }
 
-const std::string &Track::filePath() const noexcept
+std::string Track::filePath() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->filePath_;
 }
 
 std::size_t Track::fileSize() const noexcept
 {
+    std::lock_guard<std::mutex> lock{ priv_->mutex_ };
     return priv_->fileSize_;
 }
 
-const std::string &Track::artwork() const noexcept
+std::string Track::artwork() const noexcept
 {
-    if (priv_->artworkData_.empty())
+    std::unique_lock<std::mutex> lock{ priv_->mutex_ };
+
+    if (!priv_->artworkData_.empty())
     {
-        auto pms = priv_->pms_.lock();
-        if (pms != nullptr)
-        {
-            /* TODO: Error handling */
-            if (!priv_->artworkPath_.empty())
-            {
-                auto r = pms->request(priv_->artworkPath_.c_str());
-                priv_->artworkData_ = std::move(r.response.text);
-            }
-            else /* some tracks don't have artwork so use album artwork instead */
-            {
-                using namespace sequential_formats;
-
-                auto r = pms->request(priv_->album_key_.c_str());
-                JsonFormat format{ r.response.text };
-                auto mediaContainer =
-                    sequential::from_format<music::AlbumPrivate::LibraryContainer>(format);
-                r = pms->request(
-                    mediaContainer.get_MediaContainer().get_Metadata().at(0).get_thumb().c_str());
-                priv_->artworkData_ = std::move(r.response.text);
-            }
-        }
-        else
-        {
-            LOG_ERROR("Track: Invalid connection handle. PlexMediaServer "
-                      "instance was deleted!");
-        }
+        return priv_->artworkData_;
     }
 
-    return priv_->artworkData_;
+    /* Not held over the requests, so the rest of the track stays readable meanwhile */
+    lock.unlock();
+
+    auto pms = priv_->pms_.lock();
+    if (pms == nullptr)
+    {
+        LOG_ERROR("Track: Invalid connection handle. PlexMediaServer "
+                  "instance was deleted!");
+        return {};
+    }
+
+    /* TODO: Error handling */
+    auto artworkPath = priv_->artworkPath(*pms);
+    if (artworkPath.empty())
+    {
+        return {};
+    }
+
+    auto r = pms->sharedRequest(std::string{ artworkPath });
+    if (PlexMediaServerPrivate::requestFailed(r, "track artwork"))
+    {
+        return {};
+    }
+
+    lock.lock();
+    if (priv_->artworkPath_.empty() || priv_->artworkPath_ == artworkPath)
+    {
+        priv_->artworkData_ = r.response.text;
+    }
+
+    return std::move(r.response.text);
+}
+
+std::string Track::artwork(std::uint32_t width, std::uint32_t height) const noexcept
+{
+    auto pms = priv_->pms_.lock();
+    if (pms != nullptr)
+    {
+        return pms->resizedImage(priv_->artworkPath(*pms), width, height);
+    }
+    else
+    {
+        LOG_ERROR("Track: Invalid connection handle. PlexMediaServer "
+                  "instance was deleted!");
+    }
+
+    return {};
 }
 
 std::string Track::url(std::uint32_t bitrate) const noexcept
@@ -32,6 +32,9 @@
 
 #include "libspring_library_section_p.h"
 #include "libspring_logger.h"
+#include "libspring_trace.h"
+#include "libspring_music_library_p.h"
+#include "libspring_utilities_p.h"
 #include "libspring_user_properties_p.h"
 
 using namespace spring;
@@ -59,6 +62,7 @@ namespace
 {
     constexpr const char PLEX_AUTH_HOST[]{ "https://plex.tv" };
     constexpr const char PLEX_AUTH_PATH[]{ "/users/sign_in.json" };
+    constexpr const char PHOTO_TRANSCODE_REQUEST_PATH[]{ "/photo/:/transcode" };
 } // namespace
 
 PlexMediaServerPrivate::PlexMediaServerPrivate() noexcept
@@ -102,8 +106,10 @@ Error PlexMediaServerPrivate::connect(const char *serverAddress,
         }
         else
         {
+            trace::Span parse{ "json", "Parse user" };
             JsonFormat format{ result.response.text };
             auto user = sequential::from_format<UserProperties>(format);
+            parse.end();
             authenticationToken_ = user.get_user().get_authentication_token();
 
             http_.setHost(serverAddress);
@@ -114,8 +120,10 @@ Error PlexMediaServerPrivate::connect(const char *serverAddress,
             url_ = http_.url();
 
             result = PlexMediaServerPrivate::request("/servers");
+            trace::Span parseServers{ "json", "Parse servers" };
             format.parse(result.response.text);
             auto serverProperties = sequential::from_format<LibraryContainer>(format);
+            parseServers.end();
             name_ = serverProperties.get_MediaContainer().get_Server().at(0).get_name();
         }
     }
@@ -133,6 +141,7 @@ Error PlexMediaServerPrivate::connect(const char *serverAddress,
     http_.disableAuthentication();
     http_.setSSLErrorHandling(static_cast<HttpClient::SSLErrorHandling>(errorHandling));
 
+    url_ = http_.url();
     authenticationToken_ = token;
 
     return Error::noError();
@@ -159,6 +168,122 @@ HttpClient::RequestResult PlexMediaServerPrivate::request(std::string &&path) co
     return request.send();
 }
 
+HttpClient::RequestResult PlexMediaServerPrivate::sharedRequest(std::string &&path) const noexcept
+{
+    std::promise<HttpClient::RequestResult> promise{};
+    std::shared_future<HttpClient::RequestResult> result{};
+    bool owner{ false };
+
+    {
+        std::lock_guard<std::mutex> lock{ inFlightMutex_ };
+
+        auto it = inFlight_.find(path);
+        if (it != inFlight_.end())
+        {
+            result = it->second;
+        }
+        else
+        {
+            result = promise.get_future().share();
+            inFlight_.emplace(path, result);
+            owner = true;
+        }
+    }
+
+    if (owner)
+    {
+        auto key = path;
+        promise.set_value(request(std::move(path)));
+
+        std::lock_guard<std::mutex> lock{ inFlightMutex_ };
+        inFlight_.erase(key);
+    }
+    else
+    {
+        LOG_INFO("PlexMediaServer: Joining in-flight request for {}", path);
+    }
+
+    return result.get();
+}
+
+std::string PlexMediaServerPrivate::resizedImage(const std::string &path,
+                                                 std::uint32_t width,
+                                                 std::uint32_t height) const noexcept
+{
+    if (path.empty())
+    {
+        return {};
+    }
+
+    auto result =
+        sharedRequest(fmt::format("{}?width={}&height={}&minSize=1&upscale=1&url={}",
+                                  PHOTO_TRANSCODE_REQUEST_PATH, width, height,
+                                  utilities::urlEncode(path)));
+
+    if (result.error || !(result.status == HttpClient::Status::OK) ||
+        result.response.text.empty())
+    {
+        LOG_WARN("PlexMediaServer: Photo transcode failed for {}, using original image", path);
+        result = sharedRequest(std::string{ path });
+    }
+
+    return std::move(result.response.text);
+}
+
+std::string PlexMediaServerPrivate::albumThumbnailPath(const std::string &albumRatingKey) const
+    noexcept
+{
+    std::lock_guard<std::mutex> lock{ albumThumbnailsMutex_ };
+
+    auto it = albumThumbnails_.find(albumRatingKey);
+    return it != albumThumbnails_.end() ? it->second : std::string{};
+}
+
+void PlexMediaServerPrivate::setAlbumThumbnailPath(const std::string &albumRatingKey,
+                                                   const std::string &path) noexcept
+{
+    std::lock_guard<std::mutex> lock{ albumThumbnailsMutex_ };
+    albumThumbnails_[albumRatingKey] = path;
+}
+
+std::string PlexMediaServerPrivate::ratingKey(const std::string &key) noexcept
+{
+    constexpr const char METADATA_PATH[]{ "/library/metadata/" };
+    constexpr auto METADATA_PATH_LENGTH = sizeof(METADATA_PATH) - 1;
+
+    if (key.compare(0, METADATA_PATH_LENGTH, METADATA_PATH) != 0)
+    {
+        return key;
+    }
+
+    auto end = key.find('/', METADATA_PATH_LENGTH);
+    return key.substr(METADATA_PATH_LENGTH, end == std::string::npos ?
+                                                std::string::npos :
+                                                end - METADATA_PATH_LENGTH);
+}
+
+bool PlexMediaServerPrivate::requestFailed(const HttpClient::RequestResult &r,
+                                           const char *what,
+                                           Error *error) noexcept
+{
+    if (!r.error && r.status == HttpClient::Status::OK)
+    {
+        return false;
+    }
+
+    Error result = r.error ?
+                       Error{ static_cast<Error::Code>(r.error.errorCode), r.error.message } :
+                       Error{ static_cast<Error::Code>(r.status.code()), r.status.name() };
+    LOG_WARN("PlexMediaServer: Failed to fetch {}: {}", what, result.message());
+
+    if (error != nullptr)
+    {
+        *error = std::move(result);
+    }
+
+    return true;
+}
+
 PlexMediaServer::PlexMediaServer() noexcept
 {
     priv_ = std::make_shared<PlexMediaServerPrivate>();
@@ -210,9 +335,11 @@ std::vector<LibrarySection> PlexMediaServer::sections() const noexcept
     /* TODO: Error handling */
     auto result = priv_->request(LIBRARY_SECTION_REQUEST_PATH);
 
+    trace::Span parse{ "json", "Parse library sections" };
     JsonFormat format{ result.response.text };
     auto mediaContainer =
         sequential::from_format<LibrarySectionPrivate::LibrarySectionContainer>(format);
+    parse.end();
 
     std::vector<LibrarySectionPrivate *> libraries;
     libraries.reserve(mediaContainer.get_MediaContainer().get_Directory().size());
@@ -226,6 +353,11 @@ std::vector<LibrarySection> PlexMediaServer::sections() const noexcept
     return { libraries.begin(), libraries.end() };
 }
 
+MusicLibrary PlexMediaServer::musicLibrary(const std::string &sectionKey) const noexcept
+{
+    return { new MusicLibraryPrivate{ sectionKey, priv_ } };
+}
+
 std::string PlexMediaServer::customRequest(const char *path) const noexcept
 {
     auto result = priv_->request(path);
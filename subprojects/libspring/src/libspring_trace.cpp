@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2018 Romeo Calota
+ *
+ * This file is part of the SpriNG library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Author: Romeo Calota
+ */
+
+#include "libspring_trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifdef PLATFORM_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "libspring_logger.h"
+
+using namespace spring;
+using namespace spring::trace;
+
+namespace
+{
+    /* Per-thread buffers are written out once they grow past this, and when the thread exits */
+    constexpr std::size_t FLUSH_THRESHOLD{ 64 * 1024 };
+
+    struct Output
+    {
+        std::mutex mutex{};
+        std::FILE *file{ nullptr };
+        int pid{ 0 };
+        std::atomic<int> nextThreadId{ 1 };
+        std::atomic<std::uint64_t> nextFlowId{ 1 };
+    };
+
+    /* Never destroyed, threads might still be tracing while static objects are torn down */
+    Output *output{ nullptr };
+
+    void write(const std::string &events) noexcept
+    {
+        std::lock_guard<std::mutex> lock{ output->mutex };
+        if (output->file != nullptr)
+        {
+            std::fwrite(events.data(), 1, events.size(), output->file);
+        }
+    }
+
+    struct ThreadBuffer
+    {
+        ThreadBuffer() noexcept
+          : threadId{ output->nextThreadId++ }
+        {
+            events.reserve(FLUSH_THRESHOLD);
+        }
+
+        ~ThreadBuffer() noexcept { flush(); }
+
+        void flush() noexcept
+        {
+            if (!events.empty())
+            {
+                write(events);
+                events.clear();
+            }
+        }
+
+        std::string events{};
+        int threadId;
+    };
+
+    ThreadBuffer &threadBuffer() noexcept
+    {
+        static thread_local ThreadBuffer buffer{};
+        return buffer;
+    }
+
+    void appendEscaped(fmt::MemoryWriter &writer, const char *text, std::size_t size) noexcept
+    {
+        for (std::size_t it = 0; it < size; ++it)
+        {
+            const auto c = text[it];
+            if (c == '"' || c == '\\')
+            {
+                writer << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                writer.write("\\u{:04x}", static_cast<int>(c));
+            }
+            else
+            {
+                writer << c;
+            }
+        }
+    }
+
+    void appendEvent(char phase,
+                     const char *category,
+                     const char *name,
+                     std::int64_t timestamp,
+                     std::int64_t duration,
+                     std::uint64_t flowId,
+                     const std::string &detail) noexcept
+    {
+        auto &buffer = threadBuffer();
+
+        fmt::MemoryWriter event;
+        event << "{\"ph\":\"" << phase << "\",\"cat\":\"";
+        appendEscaped(event, category, std::strlen(category));
+        event << "\",\"name\":\"";
+        appendEscaped(event, name, std::strlen(name));
+        event.write("\",\"pid\":{},\"tid\":{},\"ts\":{}", output->pid, buffer.threadId, timestamp);
+
+        if (phase == 'X')
+        {
+            event.write(",\"dur\":{}", duration);
+        }
+        else if (phase == 'i')
+        {
+            event << ",\"s\":\"t\"";
+        }
+        else
+        {
+            /* The end of a flow binds to the span enclosing it rather than the next one */
+            event.write(",\"id\":{}{}", flowId, phase == 'f' ? ",\"bp\":\"e\"" : "");
+        }
+
+        if (!detail.empty())
+        {
+            event << ",\"args\":{\"detail\":\"";
+            appendEscaped(event, detail.data(), detail.size());
+            event << "\"}";
+        }
+
+        event << "},\n";
+
+        buffer.events.append(event.data(), event.size());
+        if (buffer.events.size() >= FLUSH_THRESHOLD)
+        {
+            buffer.flush();
+        }
+    }
+
+    void finish() noexcept
+    {
+        trace::internal::state = trace::internal::Disabled;
+
+        std::lock_guard<std::mutex> lock{ output->mutex };
+
+        /* Closes the array, a trailing comma isn't valid JSON */
+        std::fprintf(output->file,
+                     "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+                     "\"args\":{\"name\":\"spring\"}}\n]\n",
+                     output->pid);
+        std::fclose(output->file);
+        output->file = nullptr;
+    }
+
+    bool openOutput() noexcept
+    {
+        auto LIBSPRING_TRACE = std::getenv("LIBSPRING_TRACE");
+        if (LIBSPRING_TRACE == nullptr || LIBSPRING_TRACE[0] == '\0')
+        {
+            return false;
+        }
+
+        auto file = std::fopen(LIBSPRING_TRACE, "w");
+        if (file == nullptr)
+        {
+            LOG_ERROR("Trace: Failed to open {}: {}", LIBSPRING_TRACE, std::strerror(errno));
+            return false;
+        }
+
+        LOG_INFO("Trace: Writing trace events to {}", LIBSPRING_TRACE);
+
+        output = new Output;
+        output->file = file;
+#ifdef PLATFORM_WINDOWS
+        output->pid = _getpid();
+#else
+        output->pid = static_cast<int>(getpid());
+#endif
+        std::fputs("[\n", file);
+
+        /* Runs after the main thread's buffer was flushed by its thread_local destructor */
+        std::atexit(&finish);
+
+        return true;
+    }
+} // namespace
+
+std::atomic_int trace::internal::state{ trace::internal::Uninitialized };
+
+bool trace::internal::initialize() noexcept
+{
+    /* Thread-safe, whoever gets here first opens the output and the rest wait for it */
+    static const bool initialized = [] {
+        const auto opened = openOutput();
+        state.store(opened ? Enabled : Disabled, std::memory_order_release);
+        return opened;
+    }();
+
+    return initialized && state.load(std::memory_order_acquire) == Enabled;
+}
+
+std::int64_t trace::now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::uint64_t trace::newFlowId() noexcept
+{
+    return enabled() ? output->nextFlowId++ : 0;
+}
+
+void trace::complete(const char *category,
+                     const char *name,
+                     std::int64_t start,
+                     std::int64_t duration,
+                     const std::string &detail) noexcept
+{
+    if (enabled())
+    {
+        appendEvent('X', category, name, start, duration, 0, detail);
+    }
+}
+
+void trace::instant(const char *category, const char *name, const std::string &detail) noexcept
+{
+    if (enabled())
+    {
+        appendEvent('i', category, name, now(), 0, 0, detail);
+    }
+}
+
+std::uint64_t Span::flowOut() noexcept
+{
+    if (!active())
+    {
+        return 0;
+    }
+
+    const auto id = newFlowId();
+    appendEvent('s', "flow", "flow", now(), 0, id, {});
+
+    return id;
+}
+
+void Span::flowFrom(std::uint64_t id) noexcept
+{
+    if (active() && id != 0)
+    {
+        appendEvent('f', "flow", "flow", now(), 0, id, {});
+    }
+}
+
+void Span::end() noexcept
+{
+    if (active())
+    {
+        appendEvent('X', category_, name_, start_, now() - start_, 0, detail_);
+        start_ = -1;
+    }
+}
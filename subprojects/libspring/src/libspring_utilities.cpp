@@ -51,3 +51,28 @@ bool CaseInsensitiveCompare::operator()(const char *s1, const char *s2) const
     return (strcasecmp(s1, s2) < 0);
 #endif
 }
+
+std::string spring::utilities::urlEncode(const std::string &value) noexcept
+{
+    constexpr const char HEX_DIGITS[]{ "0123456789ABCDEF" };
+
+    std::string result{};
+    result.reserve(value.size() * 3);
+
+    for (const auto c : value)
+    {
+        const auto byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) || byte == '-' || byte == '_' || byte == '.' || byte == '~')
+        {
+            result.push_back(c);
+        }
+        else
+        {
+            result.push_back('%');
+            result.push_back(HEX_DIGITS[byte >> 4]);
+            result.push_back(HEX_DIGITS[byte & 0x0F]);
+        }
+    }
+
+    return result;
+}